@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cairomm/surface.h>
+#include <gtkmm/box.h>
+#include <gtkmm/drawingarea.h>
+
+#include <memory>
+
+#include "ALabel.hpp"
+#include "util/ring_buffer.hpp"
+
+namespace waybar {
+
+/*
+ * A label with an optional history graph of the module's main value next to it.
+ * Without a "graph" config, the module is a plain ALabel. Each sample is one column: a new
+ * sample scrolls a cached surface by one column and only paints the newest one. The whole
+ * history is only rasterized again after size, scale, color or range changes.
+ */
+class AGraph : public ALabel {
+ public:
+  // `max` is the top of the graph, 0 follows the largest sample in the history
+  AGraph(const Json::Value&, const std::string&, const std::string&, const std::string& format,
+         double max = 0, uint16_t interval = 0, bool ellipsize = false, bool enable_click = false,
+         bool enable_scroll = false);
+  virtual ~AGraph() = default;
+
+ protected:
+  // Adds a sample to the history, cheap enough to be called on every update
+  void pushSample(double value);
+  std::string getState(uint8_t value, bool lesser = false) override;
+
+ private:
+  struct Graph {
+    Gtk::DrawingArea area;
+    util::RingBuffer<double> samples;
+    int column_width;
+    // Columns are painted on `front` and scrolled by copying it onto `back`
+    Cairo::RefPtr<Cairo::ImageSurface> front;
+    Cairo::RefPtr<Cairo::ImageSurface> back;
+    Gdk::RGBA color;
+    int scale = 1;
+    // Top of the graph the cached columns were painted with
+    double top = 0;
+
+    Graph(size_t samples, int column_width) : samples(samples), column_width(column_width) {}
+  };
+
+  // The "max" of the graph config if set, `max` otherwise
+  static double resolveMax(const Json::Value& config, double max);
+  bool onDraw(const Cairo::RefPtr<Cairo::Context>& cr);
+  double top() const;
+  void rasterize(int width, int height, int scale);
+  void scroll();
+  void paintColumn(const Cairo::RefPtr<Cairo::Context>& cr, size_t index) const;
+
+  const double max_;
+  Gtk::Box box_;
+  std::unique_ptr<Graph> graph_;
+};
+
+}  // namespace waybar
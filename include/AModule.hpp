@@ -6,7 +6,10 @@
 #include <gtkmm/eventbox.h>
 #include <json/json.h>
 
+#include <chrono>
+
 #include "IModule.hpp"
+#include "util/action_coalescer.hpp"
 
 namespace waybar {
 
@@ -33,8 +36,18 @@ class AModule : public IModule {
 
   enum SCROLL_DIR { NONE, UP, DOWN, LEFT, RIGHT };
 
+  // Net scroll steps of one coalescing window, positive is up or right
+  struct ScrollSteps {
+    int vertical = 0;
+    int horizontal = 0;
+  };
+
   SCROLL_DIR getScrollDir(GdkEventScroll* e);
+  // Adds a step and runs handleScrollSteps() once the coalescing window closes
+  void queueScroll(SCROLL_DIR dir);
   bool tooltipEnabled() const;
+  // How long input events are accumulated before they are acted upon
+  std::chrono::milliseconds coalescingWindow() const;
 
   std::vector<int> pid_children_;
   const std::string name_;
@@ -47,6 +60,7 @@ class AModule : public IModule {
   virtual bool handleMouseEnter(GdkEventCrossing* const& ev);
   virtual bool handleMouseLeave(GdkEventCrossing* const& ev);
   virtual bool handleScroll(GdkEventScroll*);
+  virtual void handleScrollSteps(const ScrollSteps& steps);
   virtual bool handleRelease(GdkEventButton* const& ev);
   GObject* menu_ = nullptr;
 
@@ -57,6 +71,8 @@ class AModule : public IModule {
   bool hasUserEvents_;
   gdouble distance_scrolled_y_;
   gdouble distance_scrolled_x_;
+  ScrollSteps scroll_steps_;
+  util::ActionCoalescer scroll_coalescer_;
   std::map<std::string, std::string> eventActionMap_;
   static const inline std::map<std::pair<uint, GdkEventType>, std::string> eventMap_{
       {std::make_pair(1, GdkEventType::GDK_BUTTON_PRESS), "on-click"},
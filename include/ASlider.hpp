@@ -8,12 +8,20 @@ namespace waybar {
 class ASlider : public AModule {
  public:
   ASlider(const Json::Value& config, const std::string& name, const std::string& id);
+  // Called with the latest value at most once per coalescing window while the slider moves
   virtual void onValueChanged();
 
  protected:
   bool vertical_ = false;
   int min_ = 0, max_ = 100, curr_ = 50;
   Gtk::Scale scale_;
+  util::ActionCoalescer value_coalescer_;
+
+  // Shows a value of the backend without writing it back as a user change
+  void setValue(double value);
+
+ private:
+  sigc::connection value_changed_;
 };
 
 }  // namespace waybar
\ No newline at end of file
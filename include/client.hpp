@@ -9,6 +9,7 @@
 #include "config.hpp"
 #include "util/css_reload_helper.hpp"
 #include "util/portal.hpp"
+#include "util/wayland_globals.hpp"
 
 struct zwp_idle_inhibitor_v1;
 struct zwp_idle_inhibit_manager_v1;
@@ -27,6 +28,8 @@ class Client {
   struct wl_registry* registry = nullptr;
   struct zxdg_output_manager_v1* xdg_output_manager = nullptr;
   struct zwp_idle_inhibit_manager_v1* idle_inhibit_manager = nullptr;
+  // Every global of `registry`, for modules binding compositor specific protocols
+  util::WaylandGlobals globals;
   std::vector<std::unique_ptr<Bar>> bars;
   Config config;
   std::string bar_id;
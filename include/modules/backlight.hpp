@@ -22,6 +22,7 @@ class Backlight : public ALabel {
   auto update() -> void override;
 
   bool handleScroll(GdkEventScroll* e) override;
+  void handleScrollSteps(const ScrollSteps& steps) override;
 
   const std::string preferred_device_;
 
@@ -9,13 +9,18 @@
 #include <poll.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <string>
 #include <vector>
 
 #include "ALabel.hpp"
 #include "bar.hpp"
+#include "util/scoped_fd.hpp"
 #include "util/sleeper_thread.hpp"
+#include "util/sysfs_file.hpp"
 #include "util/udev_deleter.hpp"
 
 namespace waybar::modules {
@@ -31,20 +36,65 @@ class Battery : public ALabel {
  private:
   static inline const fs::path data_dir_ = "/sys/class/power_supply/";
 
+  // Battery attributes read on every update
+  enum class Attr : uint8_t {
+    Status,
+    CurrentNow,
+    CurrentAvg,
+    TimeToEmptyNow,
+    TimeToFullNow,
+    VoltageNow,
+    VoltageAvg,
+    ChargeFull,
+    ChargeFullDesign,
+    ChargeNow,
+    PowerNow,
+    EnergyNow,
+    EnergyFull,
+    EnergyFullDesign,
+    CycleCount,
+    Capacity,
+    Count,
+  };
+  static constexpr std::array<const char*, static_cast<size_t>(Attr::Count)> ATTR_NAMES{
+      "status",      "current_now", "current_avg", "time_to_empty_now",  "time_to_full_now",
+      "voltage_now", "voltage_avg", "charge_full", "charge_full_design", "charge_now",
+      "power_now",   "energy_now",  "energy_full", "energy_full_design", "cycle_count",
+      "capacity",
+  };
+
+  // Attributes are opened once when the battery shows up; missing ones stay closed
+  struct BatteryFiles {
+    int watch_fd = -1;
+    std::array<util::SysfsFile, static_cast<size_t>(Attr::Count)> attrs;
+
+    const util::SysfsFile& operator[](Attr attr) const { return attrs[static_cast<size_t>(attr)]; }
+  };
+
   void refreshBatteries();
   void worker();
+  void handleUevent();
+  std::chrono::milliseconds pollInterval(uint8_t capacity, float time_remaining,
+                                         const std::string& status) const;
   const std::string getAdapterStatus(uint8_t capacity) const;
   std::tuple<uint8_t, float, std::string, float, uint16_t, float> getInfos();
   const std::string formatTimeRemaining(float hoursRemaining);
   void setBarClass(std::string&);
   void processEvents(std::string& state, std::string& status, uint8_t capacity);
 
-  std::map<fs::path, int> batteries_;
+  std::map<fs::path, BatteryFiles> batteries_;
   std::unique_ptr<udev, util::UdevDeleter> udev_;
-  std::array<pollfd, 1> poll_fds_;
   std::unique_ptr<udev_monitor, util::UdevMonitorDeleter> mon_;
   fs::path adapter_;
-  int battery_watch_fd_;
+  util::SysfsFile adapter_online_;
+  util::SysfsFile adapter_status_;
+  // Closing it drops every watch
+  util::ScopedFd battery_watch_fd_;
+  std::chrono::steady_clock::time_point last_refresh_;
+  // Milliseconds on the steady clock of the last change uevent of a supply, -1 if none came yet
+  std::atomic<int64_t> last_uevent_ms_{-1};
+  // Timeout of the worker's poll, shortened while a change is due and no uevents report it
+  std::atomic<int> poll_timeout_ms_;
   std::mutex battery_list_mutex_;
   std::string old_status_;
   std::string last_event_;
@@ -52,9 +102,8 @@ class Battery : public ALabel {
   bool weightedAverage_{true};
   const Bar& bar_;
 
+  // Declared last so that it stops before the descriptors it polls are closed
   util::SleeperThread thread_;
-  util::SleeperThread thread_battery_update_;
-  util::SleeperThread thread_timer_;
 };
 
 }  // namespace waybar::modules
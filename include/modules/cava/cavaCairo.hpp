@@ -0,0 +1,36 @@
+#pragma once
+
+#include <gtkmm/drawingarea.h>
+
+#include "AModule.hpp"
+#include "cava_backend.hpp"
+#include "cava_frame_reader.hpp"
+
+namespace waybar::modules::cava {
+
+/* Draws the bar heights directly with cairo instead of building Pango markup for every frame.
+ * All bars are added to a single path and filled once per frame.
+ */
+class CavaCairo final : public AModule, public sigc::trackable {
+ public:
+  CavaCairo(const std::string&, const Json::Value&);
+  ~CavaCairo() = default;
+  auto doAction(const std::string& name) -> void override;
+
+ private:
+  std::shared_ptr<CavaBackend> backend_;
+  Gtk::DrawingArea area_;
+  bool silence_{false};
+  bool hide_on_silence_{false};
+  int bar_spacing_{1};
+  CavaFrameReader reader_;
+  // Cava method
+  void pause_resume();
+  auto onFrame(const CavaFrame& frame) -> void;
+  auto onSilence() -> void;
+  bool onDraw(const Cairo::RefPtr<Cairo::Context>& cr);
+  // ModuleActionMap
+  static inline std::map<const std::string, void (waybar::modules::cava::CavaCairo::* const)()>
+      actionMap_{{"mode", &waybar::modules::cava::CavaCairo::pause_resume}};
+};
+}  // namespace waybar::modules::cava
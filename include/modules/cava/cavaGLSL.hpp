@@ -2,8 +2,11 @@
 
 #include <epoxy/gl.h>
 
+#include <chrono>
+
 #include "AModule.hpp"
 #include "cava_backend.hpp"
+#include "cava_frame_reader.hpp"
 
 namespace waybar::modules::cava {
 
@@ -19,21 +22,35 @@ class CavaGLSL final : public AModule, public Gtk::GLArea {
   bool silence_{false};
   bool hide_on_silence_{false};
   // Cava method
-  auto onUpdate(const ::cava::audio_raw& input) -> void;
+  auto onFrame(const CavaFrame& frame) -> void;
   auto onSilence() -> void;
-  // Member variable to store the shared pointer
-  std::shared_ptr<::cava::audio_raw> m_data_;
+  CavaFrameReader reader_;
+  // Bars changed since the last render, only then the shader runs again
+  bool frame_dirty_{false};
   GLuint shaderProgram_;
-  // OpenGL variables
-  GLuint fbo_;
-  GLuint texture_;
+  // OpenGL variables. The shader samples the previous frame, so frames alternate between two
+  // framebuffers and the latest one is blitted to the widget.
+  GLuint fbos_[2];
+  GLuint textures_[2];
+  int last_fbo_{0};
   GLint uniform_bars_;
   GLint uniform_previous_bars_;
   GLint uniform_bars_count_;
   GLint uniform_time_;
+  // Render statistics, refreshed about once per second. The submit time is the CPU time spent
+  // issuing the GL calls of a render, the GPU may finish them later.
+  std::chrono::steady_clock::time_point stats_start_{std::chrono::steady_clock::now()};
+  std::chrono::steady_clock::duration stats_submit_{0};
+  int stats_frames_{0};
+  double fps_{0};
+  double submit_ms_{0};
   // Methods
   void onRealize();
   bool onRender(const Glib::RefPtr<Gdk::GLContext>& context);
+  void drawFrame(const CavaFrame& frame);
+  void updateStats(std::chrono::steady_clock::duration submit);
+  bool onQueryTooltip(int x, int y, bool keyboard_tooltip,
+                      const Glib::RefPtr<Gtk::Tooltip>& tooltip);
 
   void initShaders();
   void initSurface();
@@ -2,6 +2,7 @@
 
 #include "ALabel.hpp"
 #include "cava_backend.hpp"
+#include "cava_frame_reader.hpp"
 
 namespace waybar::modules::cava {
 
@@ -13,6 +14,7 @@ class Cava final : public ALabel, public sigc::trackable {
 
  private:
   std::shared_ptr<CavaBackend> backend_;
+  CavaFrameReader reader_;
   // Text to display
   Glib::ustring label_text_{""};
   bool silence_{false};
@@ -21,7 +23,7 @@ class Cava final : public ALabel, public sigc::trackable {
   int ascii_range_{0};
   // Cava method
   void pause_resume();
-  auto onUpdate(const std::string& input) -> void;
+  auto onFrame(const CavaFrame& frame) -> void;
   auto onSilence() -> void;
   // ModuleActionMap
   static inline std::map<const std::string, void (waybar::modules::cava::Cava::* const)()>
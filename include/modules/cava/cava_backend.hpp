@@ -3,26 +3,28 @@
 #include <json/json.h>
 #include <sigc++/sigc++.h>
 
-#include "util/sleeper_thread.hpp"
-
-namespace cava {
-extern "C" {
-// Need sdl_glsl output feature to be enabled on libcava
-#ifndef SDL_GLSL
-#define SDL_GLSL
-#endif
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
-#include <cava/common.h>
-
-#ifdef SDL_GLSL
-#undef SDL_GLSL
-#endif
-}
-}  // namespace cava
+#include "cava_capture.hpp"
+#include "util/sleeper_thread.hpp"
+#include "util/triple_buffer.hpp"
 
 namespace waybar::modules::cava {
 using namespace std::literals::chrono_literals;
 
+// One visualizer frame, copied into preallocated buffers by the backend thread
+struct CavaFrame {
+  std::string output;  // bar levels for the text frontend
+  std::vector<float> bars_raw;
+  std::vector<float> previous_bars_raw;
+  int number_of_bars{0};
+};
+using CavaFrameSlot = util::TripleBuffer<CavaFrame>;
+
 class CavaBackend final {
  public:
   static std::shared_ptr<CavaBackend> inst(const Json::Value& config);
@@ -35,50 +37,66 @@ class CavaBackend final {
   const struct ::cava::config_params* getPrm();
   std::chrono::milliseconds getFrameTimeMilsec();
 
+  // Frames are handed over through one slot per frontend, read on the frontend's own schedule
+  std::shared_ptr<CavaFrameSlot> subscribe();
+  void unsubscribe(const std::shared_ptr<CavaFrameSlot>& slot);
+
   // Signal accessor
-  using type_signal_update = sigc::signal<void(const std::string&)>;
+  // Emitted from the backend thread when frames start flowing (after silence or a forced update)
+  using type_signal_update = sigc::signal<void()>;
   type_signal_update signal_update();
-  using type_signal_audio_raw_update = sigc::signal<void(const ::cava::audio_raw&)>;
-  type_signal_audio_raw_update signal_audio_raw_update();
   using type_signal_silence = sigc::signal<void()>;
   type_signal_silence signal_silence();
 
  private:
   CavaBackend(const Json::Value& config);
-  util::SleeperThread read_thread_;
   util::SleeperThread out_thread_;
 
-  // Cava API to read audio source
-  ::cava::ptr input_source_{NULL};
+  // Audio source, shared with other backends reading the same input
+  std::shared_ptr<CavaCapture> capture_;
+  CavaCapture::ConsumerId consumer_id_{0};
+  // Samples handed over by the capture since the previous frame
+  std::vector<double> samples_;
 
-  struct ::cava::error_s error_{};          // cava errors
-  struct ::cava::config_params prm_{};      // cava parameters
-  struct ::cava::audio_raw audio_raw_{};    // cava handled raw audio data(is based on audio_data)
-  struct ::cava::audio_data audio_data_{};  // cava audio data
-  struct ::cava::cava_plan* plan_{NULL};    //{new cava_plan{}};
+  struct ::cava::error_s error_{};        // cava errors
+  struct ::cava::config_params prm_{};    // cava parameters
+  struct ::cava::audio_raw audio_raw_{};  // cava handled raw audio data(is based on audio_data)
+  struct ::cava::cava_plan* plan_{NULL};  //{new cava_plan{}};
+  // Source format the plan was built for
+  CavaCapture::Format plan_format_{};
 
   std::chrono::seconds fetch_input_delay_{4};
   // Delay to handle audio source
   std::chrono::milliseconds frame_time_milsec_{1s};
 
-  const Json::Value& config_;
+  // Own copy: the backend may outlive the bar whose module created it
+  const Json::Value config_;
   int re_paint_{0};
   bool silence_{false};
   bool silence_prev_{false};
+  // Only touched on out_thread_
+  bool suspended_{false};
+  // Pause toggles requested by the frontends, applied on out_thread_
+  std::atomic<unsigned> pause_toggles_{0};
   std::chrono::seconds suspend_silence_delay_{0};
   int sleep_counter_{0};
   std::string output_{};
+  std::atomic<bool> force_update_{false};
+  std::mutex subscribers_mutex_;
+  std::vector<std::shared_ptr<CavaFrameSlot>> subscribers_;
   // Methods
   void invoke();
   void execute();
   bool isSilence();
   void doUpdate(bool force = false);
+  void togglePause();
+  void publishFrame();
   void loadConfig();
+  void buildPlan(const CavaCapture::Format& format);
   void freeBackend();
 
   // Signal
   type_signal_update m_signal_update_;
-  type_signal_audio_raw_update m_signal_audio_raw_;
   type_signal_silence m_signal_silence_;
 };
 }  // namespace waybar::modules::cava
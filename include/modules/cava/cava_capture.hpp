@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "util/sleeper_thread.hpp"
+
+namespace cava {
+extern "C" {
+// Need sdl_glsl output feature to be enabled on libcava
+#ifndef SDL_GLSL
+#define SDL_GLSL
+#endif
+
+#include <cava/common.h>
+
+#ifdef SDL_GLSL
+#undef SDL_GLSL
+#endif
+}
+}  // namespace cava
+
+namespace waybar::modules::cava {
+
+/* One audio capture, shared by every backend that reads the same input method and source.
+ * Each backend attaches as a consumer with its own read offset into the capture buffer, so
+ * backends with different cava settings see every sample while the source is opened once.
+ */
+class CavaCapture final {
+ public:
+  using ConsumerId = size_t;
+  struct Format {
+    unsigned int rate{0};
+    int channels{0};
+    int format{-1};
+    bool operator==(const Format&) const = default;
+  };
+
+  static std::shared_ptr<CavaCapture> inst(struct ::cava::config_params& prm,
+                                           std::chrono::seconds fetch_input_delay);
+
+  ~CavaCapture();
+
+  ConsumerId attach();
+  void detach(ConsumerId id);
+  // Copies the samples that arrived since the consumer's previous read
+  Format read(ConsumerId id, std::vector<double>& samples);
+  // The capture itself is only suspended while all of its consumers are
+  void suspend(ConsumerId id, bool suspend);
+  bool isSilence();
+  size_t bufferSize() const;
+  // Builds a plan for the current source format
+  void initPlan(struct ::cava::audio_raw* audio_raw, struct ::cava::config_params* prm,
+                struct ::cava::cava_plan** plan);
+
+ private:
+  struct Consumer {
+    int offset{0};
+    bool suspended{false};
+  };
+
+  CavaCapture(struct ::cava::config_params& prm, std::chrono::seconds fetch_input_delay);
+  Format format() const;
+
+  util::SleeperThread read_thread_;
+  ::cava::ptr input_source_{NULL};
+  struct ::cava::audio_data audio_data_{};
+  std::chrono::seconds fetch_input_delay_;
+  // Format and rate get_input() set up, restored before every read attempt
+  decltype(::cava::audio_data::format) input_format_{-1};
+  decltype(::cava::audio_data::rate) input_rate_{0};
+  // Guarded by audio_data_.lock, like the capture buffer itself
+  std::map<ConsumerId, Consumer> consumers_;
+  ConsumerId next_consumer_{0};
+  // Set once the capture is destroyed, so the read thread stops retrying the input
+  bool closing_{false};
+};
+
+}  // namespace waybar::modules::cava
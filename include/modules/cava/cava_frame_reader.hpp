@@ -0,0 +1,43 @@
+#pragma once
+
+#include <gtkmm/widget.h>
+
+#include <functional>
+#include <memory>
+
+#include "cava_backend.hpp"
+
+namespace waybar::modules::cava {
+
+/* Pulls frames from the backend on a widget's frame clock.
+ * The backend never queues anything onto the main loop per frame: it only publishes into this
+ * reader's slot. While audio is playing the reader checks the slot once per frame clock tick and
+ * hands new frames to the frontend; during silence the tick callback is removed so an idle
+ * visualizer costs no wakeups.
+ */
+class CavaFrameReader final : public sigc::trackable {
+ public:
+  using FrameCallback = std::function<void(const CavaFrame&)>;
+
+  CavaFrameReader(std::shared_ptr<CavaBackend> backend, Gtk::Widget& widget,
+                  FrameCallback on_frame);
+  ~CavaFrameReader();
+
+  void start();
+  void stop();
+  // Last frame handed to the frontend, valid on the main thread until the next tick
+  const CavaFrame* frame() const;
+
+ private:
+  bool onTick(const Glib::RefPtr<Gdk::FrameClock>& clock);
+
+  std::shared_ptr<CavaBackend> backend_;
+  std::shared_ptr<CavaFrameSlot> slot_;
+  Gtk::Widget& widget_;
+  FrameCallback on_frame_;
+  sigc::connection update_connection_;
+  guint tick_id_{0};
+  bool has_frame_{false};
+};
+
+}  // namespace waybar::modules::cava
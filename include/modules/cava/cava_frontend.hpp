@@ -1,6 +1,7 @@
 #pragma once
 
 #ifdef HAVE_LIBCAVA
+#include "cavaCairo.hpp"
 #include "cavaRaw.hpp"
 #include "cava_backend.hpp"
 #ifdef HAVE_LIBCAVAGLSL
@@ -12,6 +13,9 @@ namespace waybar::modules::cava {
 AModule* getModule(const std::string& id, const Json::Value& config) {
 #ifdef HAVE_LIBCAVA
   const std::shared_ptr<CavaBackend> backend_{waybar::modules::cava::CavaBackend::inst(config)};
+  if (config["frontend"].isString() && config["frontend"].asString() == "cairo") {
+    return new waybar::modules::cava::CavaCairo(id, config);
+  }
   switch (backend_->getPrm()->output) {
 #ifdef HAVE_LIBCAVAGLSL
     case ::cava::output_method::OUTPUT_SDL_GLSL:
@@ -9,12 +9,12 @@
 #include <utility>
 #include <vector>
 
-#include "ALabel.hpp"
+#include "AGraph.hpp"
 #include "util/sleeper_thread.hpp"
 
 namespace waybar::modules {
 
-class Cpu : public ALabel {
+class Cpu : public AGraph {
  public:
   Cpu(const std::string&, const Json::Value&);
   virtual ~Cpu() = default;
@@ -20,11 +20,17 @@ class CpuFrequency : public ALabel {
   virtual ~CpuFrequency() = default;
   auto update() -> void override;
 
+  // Frequency in MHz shared by a number of CPUs, such as all CPUs of a cpufreq policy
+  struct FrequencySample {
+    float frequency;
+    uint32_t cpus = 1;
+  };
+
   // This is a static member because it is also used by the cpu module.
   static std::tuple<float, float, float> getCpuFrequency();
 
  private:
-  static std::vector<float> parseCpuFrequencies();
+  static std::vector<FrequencySample> parseCpuFrequencies();
 
   util::SleeperThread thread_;
 };
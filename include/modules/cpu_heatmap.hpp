@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cairomm/surface.h>
+#include <gtkmm/drawingarea.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "AModule.hpp"
+#include "util/sleeper_thread.hpp"
+
+namespace waybar::modules {
+
+/*
+ * A grid of one cell per core, colored by the core's usage.
+ * Usage is quantized into one bucket per color of the ramp. Only cells whose bucket changed are
+ * painted on the cached surface and invalidated, so a tick on a many-core machine usually
+ * repaints a handful of cells and builds no markup.
+ */
+class CpuHeatmap : public AModule {
+ public:
+  CpuHeatmap(const std::string&, const Json::Value&);
+  virtual ~CpuHeatmap() = default;
+  auto update() -> void override;
+
+ private:
+  // Bucket of cores that are offline
+  static constexpr int OFFLINE = -1;
+
+  bool onDraw(const Cairo::RefPtr<Cairo::Context>& cr);
+  bool onQueryTooltip(int x, int y, bool keyboard_tooltip,
+                      const Glib::RefPtr<Gtk::Tooltip>& tooltip);
+  void resize(size_t cores);
+  void rasterize(int width, int height, int scale);
+  void paintCell(const Cairo::RefPtr<Cairo::Context>& cr, size_t core) const;
+  // Cell of `core` in logical pixels
+  Gdk::Rectangle cellArea(size_t core) const;
+  int bucket(uint16_t usage) const;
+
+  Gtk::DrawingArea area_;
+  std::vector<Gdk::RGBA> colors_;
+  const int rows_;
+  // Rows actually used, fewer than configured on machines with few cores
+  int grid_rows_ = 1;
+  const int cell_size_;
+  const int cell_spacing_;
+  const std::chrono::milliseconds interval_;
+
+  std::vector<std::tuple<size_t, size_t>> prev_times_;
+  std::vector<uint16_t> usage_;
+  std::vector<int> buckets_;
+  // Cells as painted with the current buckets, rasterized again after size or scale changes
+  Cairo::RefPtr<Cairo::ImageSurface> surface_;
+
+  util::SleeperThread thread_;
+};
+
+}  // namespace waybar::modules
@@ -23,9 +23,10 @@ class CpuUsage : public ALabel {
   // This is a static member because it is also used by the cpu module.
   static std::tuple<std::vector<uint16_t>, std::string> getCpuUsage(
       std::vector<std::tuple<size_t, size_t>>&);
+  // Idle and total time of all CPUs, then of each CPU; also used by the cpu_heatmap module
+  static std::vector<std::tuple<size_t, size_t>> parseCpuinfo();
 
  private:
-  static std::vector<std::tuple<size_t, size_t>> parseCpuinfo();
 
   std::vector<std::tuple<size_t, size_t>> prev_times_;
 
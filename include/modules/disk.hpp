@@ -5,13 +5,13 @@
 
 #include <fstream>
 
-#include "ALabel.hpp"
+#include "AGraph.hpp"
 #include "util/format.hpp"
 #include "util/sleeper_thread.hpp"
 
 namespace waybar::modules {
 
-class Disk : public ALabel {
+class Disk : public AGraph {
  public:
   Disk(const std::string&, const Json::Value&);
   virtual ~Disk() = default;
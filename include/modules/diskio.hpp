@@ -0,0 +1,59 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ALabel.hpp"
+#include "util/diskstats.hpp"
+#include "util/sleeper_thread.hpp"
+#include "util/sysfs_file.hpp"
+
+namespace waybar::modules {
+
+class Diskio : public ALabel {
+ public:
+  Diskio(const std::string&, const Json::Value&);
+  virtual ~Diskio() = default;
+  auto update() -> void override;
+
+ private:
+  struct Device {
+    util::DiskStats counters;
+    // Rates since the previous sample, in bytes and requests per second
+    double read_bytes = 0;
+    double write_bytes = 0;
+    double read_iops = 0;
+    double write_iops = 0;
+    // Share of the interval in which the device was busy, in percent
+    double utilization = 0;
+    uint64_t generation = 0;
+  };
+
+  bool accept(std::string_view name);
+  bool matches(const std::string& name) const;
+  void sample();
+
+  util::SysfsFile file_;
+  // Reused between samples, so scanning the file allocates nothing once the devices are known
+  std::string contents_;
+  std::vector<std::string> globs_;
+  // Literal beginnings of the globs; lines starting with none of them are skipped at once
+  std::vector<std::string> prefixes_;
+  bool partitions_ = false;
+  // Whether a device name is displayed, decided once per name
+  std::map<std::string, bool, std::less<>> accepted_;
+  std::map<std::string, Device, std::less<>> devices_;
+  uint64_t generation_ = 0;
+  std::chrono::steady_clock::time_point sampled_at_;
+
+  util::SleeperThread thread_;
+};
+
+}  // namespace waybar::modules
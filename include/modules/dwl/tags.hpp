@@ -3,6 +3,8 @@
 #include <gtkmm/button.h>
 #include <wayland-client.h>
 
+#include <memory>
+
 #include "AModule.hpp"
 #include "bar.hpp"
 #include "dwl-ipc-unstable-v2-client-protocol.h"
@@ -21,10 +23,10 @@ class Tags : public waybar::AModule {
   void handle_primary_clicked(uint32_t tag);
   bool handle_button_press(GdkEventButton* event_button, uint32_t tag);
 
-  struct zdwl_ipc_manager_v2* status_manager_;
-  struct wl_seat* seat_;
-
  private:
+  // Shared with the other dwl modules
+  std::shared_ptr<struct zdwl_ipc_manager_v2> status_manager_;
+  std::shared_ptr<struct wl_seat> seat_;
   const waybar::Bar& bar_;
   Gtk::Box box_;
   std::vector<Gtk::Button> buttons_;
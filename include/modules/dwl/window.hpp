@@ -2,6 +2,7 @@
 
 #include <fmt/format.h>
 
+#include <memory>
 #include <string>
 
 #include "AAppIconLabel.hpp"
@@ -22,10 +23,10 @@ class Window : public AAppIconLabel, public sigc::trackable {
   void handle_layout_symbol(const char* layout_symbol);
   void handle_frame();
 
-  struct zdwl_ipc_manager_v2* status_manager_;
-
  private:
   const Bar& bar_;
+  // Shared with the other dwl modules
+  std::shared_ptr<struct zdwl_ipc_manager_v2> status_manager_;
 
   std::string title_;
   std::string appid_;
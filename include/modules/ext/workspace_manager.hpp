@@ -22,7 +22,7 @@ class WorkspaceManager final : public AModule {
  public:
   WorkspaceManager(const std::string& id, const waybar::Bar& bar, const Json::Value& config);
   ~WorkspaceManager() override;
-  void register_manager(wl_registry* registry, uint32_t name, uint32_t version);
+  void register_manager();
   void remove_workspace_group(uint32_t id);
   void remove_workspace(uint32_t id);
   void set_needs_sorting() { needs_sorting_ = true; }
@@ -9,12 +9,12 @@
 #include <utility>
 #include <vector>
 
-#include "ALabel.hpp"
+#include "AGraph.hpp"
 #include "util/sleeper_thread.hpp"
 
 namespace waybar::modules {
 
-class Load : public ALabel {
+class Load : public AGraph {
  public:
   Load(const std::string&, const Json::Value&);
   virtual ~Load() = default;
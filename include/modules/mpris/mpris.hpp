@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <optional>
 #include <string>
@@ -12,7 +14,6 @@ extern "C" {
 }
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
 
 namespace waybar::modules::mpris {
 
@@ -30,6 +31,7 @@ class Mpris : public ALabel {
   static auto onPlayerPause(PlayerctlPlayer*, gpointer) -> void;
   static auto onPlayerStop(PlayerctlPlayer*, gpointer) -> void;
   static auto onPlayerMetadata(PlayerctlPlayer*, GVariant*, gpointer) -> void;
+  static auto onPlayerSeeked(PlayerctlPlayer*, gint64, gpointer) -> void;
 
   struct PlayerInfo {
     std::string name;
@@ -41,9 +43,25 @@ class Mpris : public ALabel {
     std::optional<std::string> title;
     std::optional<std::string> length;    // as HH:MM:SS
     std::optional<std::string> position;  // same format
+
+    std::optional<int64_t> length_us;
+    // Position reported at position_synced_at_, extrapolated with rate while playing
+    std::optional<int64_t> position_us;
+    double rate = 1.0;
   };
 
   auto getPlayerInfo() -> std::optional<PlayerInfo>;
+  auto watchPlaybackRate(PlayerctlPlayer*) -> void;
+  auto unwatchPlaybackRate() -> void;
+  auto setPlaybackRate(double) -> void;
+  static auto onRateBus(GObject*, GAsyncResult*, gpointer) -> void;
+  static auto onRateReply(GObject*, GAsyncResult*, gpointer) -> void;
+  static auto onRatePropertiesChanged(GDBusConnection*, const gchar*, const gchar*, const gchar*,
+                                      const gchar*, GVariant*, gpointer) -> void;
+  auto currentPosition(const PlayerInfo&) const -> std::optional<int64_t>;
+  auto schedulePositionUpdate() -> void;
+  auto connectPlayer(PlayerctlPlayer*) -> void;
+  auto resync() -> void;
   auto getIconFromJson(const Json::Value&, const std::string&) -> std::string;
   auto getArtistStr(const PlayerInfo&, bool) -> std::string;
   auto getAlbumStr(const PlayerInfo&, bool) -> std::string;
@@ -82,8 +100,19 @@ class Mpris : public ALabel {
   std::string lastStatus;
   std::string lastPlayer;
 
-  util::SleeperThread thread_;
-  std::chrono::time_point<std::chrono::system_clock> last_update_;
+  // Player state of the last resync; only signals from the player invalidate it
+  std::optional<PlayerInfo> info_;
+  bool info_dirty_ = true;
+  std::chrono::steady_clock::time_point position_synced_at_;
+  sigc::connection position_timer_;
+  sigc::connection resync_timer_;
+
+  // MPRIS Rate of the active player, watched on its bus
+  double rate_ = 1.0;
+  std::string rate_bus_name_;
+  GCancellable* rate_cancellable_ = nullptr;
+  GDBusConnection* rate_connection_ = nullptr;
+  guint rate_subscription_ = 0;
 };
 
 }  // namespace waybar::modules::mpris
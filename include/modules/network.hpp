@@ -11,7 +11,7 @@
 #include <optional>
 #include <vector>
 
-#include "ALabel.hpp"
+#include "AGraph.hpp"
 #include "util/sleeper_thread.hpp"
 #ifdef WANT_RFKILL
 #include "util/rfkill.hpp"
@@ -21,7 +21,7 @@ enum ip_addr_pref : uint8_t { IPV4, IPV6, IPV4_6 };
 
 namespace waybar::modules {
 
-class Network : public ALabel {
+class Network : public AGraph {
  public:
   Network(const std::string&, const Json::Value&);
   virtual ~Network();
@@ -34,12 +34,15 @@ class Network : public ALabel {
   static int handleEvents(struct nl_msg*, void*);
   static int handleEventsDone(struct nl_msg*, void*);
   static int handleScan(struct nl_msg*, void*);
+  static int handleLinkStats(struct nl_msg*, void*);
 
   void askForStateDump(void);
 
   void worker();
   void createInfoSocket();
   void createEventSocket();
+  void createStatsSocket();
+  void updateEventFilter();
   void parseEssid(struct nlattr**);
   void parseSignal(struct nlattr**);
   void parseFreq(struct nlattr**);
@@ -51,12 +54,17 @@ class Network : public ALabel {
   const std::string getNetworkState() const;
   void clearIface();
   std::optional<std::pair<unsigned long long, unsigned long long>> readBandwidthUsage();
+  std::optional<std::pair<unsigned long long, unsigned long long>> readLinkStats();
+  std::optional<std::pair<unsigned long long, unsigned long long>> readNetDev();
 
   int ifid_{-1};
   ip_addr_pref addr_pref_{ip_addr_pref::IPV4};
   struct sockaddr_nl nladdr_{0};
   struct nl_sock* sock_{nullptr};
   struct nl_sock* ev_sock_{nullptr};
+  // Synchronous RTM_GETLINK requests for the byte counters of ifid_
+  struct nl_sock* stats_sock_{nullptr};
+  std::optional<std::pair<unsigned long long, unsigned long long>> link_stats_;
   int efd_{-1};
   int ev_fd_{-1};
   int nl80211_id_{-1};
@@ -67,6 +75,10 @@ class Network : public ALabel {
   bool want_addr_dump_{false};
   bool dump_in_progress_{false};
   bool is_p2p_{false};
+  // Set by event handlers, the worker emits one update per batch of events
+  bool update_pending_{false};
+  bool filter_attached_{false};
+  int filter_ifid_{-1};
 
   unsigned long long bandwidth_down_total_{0};
   unsigned long long bandwidth_up_total_{0};
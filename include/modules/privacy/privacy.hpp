@@ -7,21 +7,23 @@
 #include "util/pipewire/pipewire_backend.hpp"
 #include "util/pipewire/privacy_node_info.hpp"
 
-using waybar::util::PipewireBackend::PrivacyNodeInfo;
+using waybar::util::PipewireBackend::PrivacyNodeChange;
 
 namespace waybar::modules::privacy {
 
 class Privacy : public AModule {
  public:
   Privacy(const std::string&, const Json::Value&, Gtk::Orientation, const std::string& pos);
+  ~Privacy() override;
   auto update() -> void override;
 
-  void onPrivacyNodesChanged();
+  // Called from the PipeWire thread
+  void onPrivacyNodeChanged(const PrivacyNodeChange& change);
 
  private:
-  std::list<PrivacyNodeInfo*> nodes_screenshare;  // Screen is being shared
-  std::list<PrivacyNodeInfo*> nodes_audio_in;     // Application is using the microphone
-  std::list<PrivacyNodeInfo*> nodes_audio_out;    // Application is outputting audio
+  PrivacyNodes nodes_screenshare;  // Screen is being shared
+  PrivacyNodes nodes_audio_in;     // Application is using the microphone
+  PrivacyNodes nodes_audio_out;    // Application is outputting audio
 
   std::mutex mutex_;
   sigc::connection visibility_conn;
@@ -35,6 +37,7 @@ class Privacy : public AModule {
   bool ignore_monitor = true;
 
   std::shared_ptr<util::PipewireBackend::PipewireBackend> backend = nullptr;
+  util::PipewireBackend::PipewireBackend::SubscriptionId subscription_;
 };
 
 }  // namespace waybar::modules::privacy
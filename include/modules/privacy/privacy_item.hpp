@@ -2,6 +2,7 @@
 
 #include <json/value.h>
 
+#include <map>
 #include <string>
 
 #include "gtkmm/box.h"
@@ -9,23 +10,26 @@
 #include "gtkmm/revealer.h"
 #include "util/pipewire/privacy_node_info.hpp"
 
-using waybar::util::PipewireBackend::PrivacyNodeInfo;
+using waybar::util::PipewireBackend::PrivacyNode;
 using waybar::util::PipewireBackend::PrivacyNodeType;
 
 namespace waybar::modules::privacy {
 
+// Nodes in use, by id
+using PrivacyNodes = std::map<uint32_t, PrivacyNode>;
+
 class PrivacyItem : public Gtk::Revealer {
  public:
-  PrivacyItem(const Json::Value& config_, enum PrivacyNodeType privacy_type_,
-              std::list<PrivacyNodeInfo*>* nodes, Gtk::Orientation orientation,
-              const std::string& pos, const uint icon_size, const uint transition_duration);
+  PrivacyItem(const Json::Value& config_, enum PrivacyNodeType privacy_type_, PrivacyNodes* nodes,
+              Gtk::Orientation orientation, const std::string& pos, const uint icon_size,
+              const uint transition_duration);
 
   enum PrivacyNodeType privacy_type;
 
   void set_in_use(bool in_use);
 
  private:
-  std::list<PrivacyNodeInfo*>* nodes;
+  PrivacyNodes* nodes;
 
   sigc::connection signal_conn;
 
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+
+#include "ALabel.hpp"
+#include "util/scoped_fd.hpp"
+#include "util/sleeper_thread.hpp"
+#include "util/sysfs_file.hpp"
+
+namespace waybar::modules {
+
+class Psi : public ALabel {
+ public:
+  Psi(const std::string&, const Json::Value&);
+  virtual ~Psi() = default;
+  auto update() -> void override;
+
+ private:
+  void registerTrigger(const std::string& trigger);
+  void worker();
+
+  std::string resource_;
+  std::filesystem::path path_;
+  util::SysfsFile file_;
+  // Becomes readable with POLLPRI whenever the trigger's stall threshold is crossed
+  util::ScopedFd trigger_fd_;
+  // Averages decay after a stall, so they are sampled on the interval until avg10 reaches zero
+  std::atomic<bool> stalling_{true};
+
+  util::SleeperThread thread_;
+};
+
+}  // namespace waybar::modules
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdlib>
 #include <memory>
 
 #include "ALabel.hpp"
@@ -14,14 +15,16 @@ namespace waybar::modules {
 class Pulseaudio : public ALabel {
  public:
   Pulseaudio(const std::string&, const Json::Value&);
-  virtual ~Pulseaudio() = default;
+  virtual ~Pulseaudio();
   auto update() -> void override;
 
  private:
   bool handleScroll(GdkEventScroll* e) override;
+  void handleScrollSteps(const ScrollSteps& steps) override;
   const std::vector<std::string> getPulseIcon() const;
 
   std::shared_ptr<util::AudioBackend> backend = nullptr;
+  util::AudioBackend::SubscriptionId subscription_;
 };
 
 }  // namespace waybar::modules
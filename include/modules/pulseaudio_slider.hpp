@@ -14,7 +14,7 @@ enum class PulseaudioSliderTarget {
 class PulseaudioSlider : public ASlider {
  public:
   PulseaudioSlider(const std::string&, const Json::Value&);
-  virtual ~PulseaudioSlider() = default;
+  virtual ~PulseaudioSlider();
 
   void update() override;
   void onValueChanged() override;
@@ -22,6 +22,7 @@ class PulseaudioSlider : public ASlider {
  private:
   std::shared_ptr<util::AudioBackend> backend = nullptr;
   PulseaudioSliderTarget target = PulseaudioSliderTarget::Sink;
+  util::AudioBackend::SubscriptionId subscription_;
 };
 
 }  // namespace waybar::modules
\ No newline at end of file
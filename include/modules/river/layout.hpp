@@ -2,6 +2,8 @@
 
 #include <wayland-client.h>
 
+#include <memory>
+
 #include "ALabel.hpp"
 #include "bar.hpp"
 #include "river-status-unstable-v1-client-protocol.h"
@@ -19,10 +21,10 @@ class Layout : public waybar::ALabel {
   void handle_focused_output(struct wl_output* output);
   void handle_unfocused_output(struct wl_output* output);
 
-  struct zriver_status_manager_v1* status_manager_;
-  struct wl_seat* seat_;
-
  private:
+  // Shared with the other river modules
+  std::shared_ptr<struct zriver_status_manager_v1> status_manager_;
+  std::shared_ptr<struct wl_seat> seat_;
   const waybar::Bar& bar_;
   std::string name_;
   struct wl_output* output_;          // stores the output this module belongs to
@@ -2,6 +2,8 @@
 
 #include <wayland-client.h>
 
+#include <memory>
+
 #include "ALabel.hpp"
 #include "bar.hpp"
 #include "river-status-unstable-v1-client-protocol.h"
@@ -16,10 +18,10 @@ class Mode : public waybar::ALabel {
   // Handlers for wayland events
   void handle_mode(const char* mode);
 
-  struct zriver_status_manager_v1* status_manager_;
-  struct wl_seat* seat_;
-
  private:
+  // Shared with the other river modules
+  std::shared_ptr<struct zriver_status_manager_v1> status_manager_;
+  std::shared_ptr<struct wl_seat> seat_;
   const waybar::Bar& bar_;
   std::string mode_;
   struct zriver_seat_status_v1* seat_status_;
@@ -3,6 +3,8 @@
 #include <gtkmm/button.h>
 #include <wayland-client.h>
 
+#include <memory>
+
 #include "AModule.hpp"
 #include "bar.hpp"
 #include "river-control-unstable-v1-client-protocol.h"
@@ -25,11 +27,11 @@ class Tags : public waybar::AModule {
   void handle_primary_clicked(uint32_t tag);
   bool handle_button_press(GdkEventButton* event_button, uint32_t tag);
 
-  struct zriver_status_manager_v1* status_manager_;
-  struct zriver_control_v1* control_;
-  struct wl_seat* seat_;
-
  private:
+  // Shared with the other river modules, the status manager is released once shown
+  std::shared_ptr<struct zriver_status_manager_v1> status_manager_;
+  std::shared_ptr<struct zriver_control_v1> control_;
+  std::shared_ptr<struct wl_seat> seat_;
   const waybar::Bar& bar_;
   Gtk::Box box_;
   std::vector<Gtk::Button> buttons_;
@@ -3,6 +3,8 @@
 #include <gtkmm/button.h>
 #include <wayland-client.h>
 
+#include <memory>
+
 #include "ALabel.hpp"
 #include "bar.hpp"
 #include "river-status-unstable-v1-client-protocol.h"
@@ -20,10 +22,10 @@ class Window : public waybar::ALabel {
   void handle_focused_output(struct wl_output* output);
   void handle_unfocused_output(struct wl_output* output);
 
-  struct zriver_status_manager_v1* status_manager_;
-  struct wl_seat* seat_;
-
  private:
+  // Shared with the other river modules
+  std::shared_ptr<struct zriver_status_manager_v1> status_manager_;
+  std::shared_ptr<struct wl_seat> seat_;
   const waybar::Bar& bar_;
   struct wl_output* output_;          // stores the output this module belongs to
   struct wl_output* focused_output_;  // stores the currently focused output
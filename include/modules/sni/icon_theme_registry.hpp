@@ -0,0 +1,48 @@
+#pragma once
+
+#include <gtkmm/icontheme.h>
+#include <spdlog/spdlog.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace waybar::modules::SNI {
+
+/* Icon themes for items that ship their own IconThemePath.
+ * Every tray item on every bar with the same IconThemePath shares one Gtk::IconTheme, so the
+ * theme directories are scanned and cached once instead of once per item. The registry only keeps
+ * weak references: a theme is freed when the last item holding it lets go, and its entry is
+ * dropped on the next lookup.
+ */
+class IconThemeRegistry {
+ public:
+  static IconThemeRegistry& instance() {
+    static IconThemeRegistry instance;
+    return instance;
+  }
+
+  std::shared_ptr<Gtk::IconTheme> getTheme(const std::string& icon_theme_path) {
+    std::erase_if(themes_, [](const auto& entry) { return entry.second.expired(); });
+    auto& entry = themes_[icon_theme_path];
+    if (auto icon_theme = entry.lock()) {
+      return icon_theme;
+    }
+
+    auto theme = Gtk::IconTheme::create();
+    theme->set_search_path({icon_theme_path});
+    // Shares ownership of the RefPtr while handing out the theme itself
+    auto holder = std::make_shared<Glib::RefPtr<Gtk::IconTheme>>(theme);
+    auto icon_theme = std::shared_ptr<Gtk::IconTheme>(holder, theme.operator->());
+    entry = icon_theme;
+    spdlog::debug("Created tray icon theme for {} ({} in use)", icon_theme_path, themes_.size());
+    return icon_theme;
+  }
+
+ private:
+  IconThemeRegistry() = default;
+
+  std::unordered_map<std::string, std::weak_ptr<Gtk::IconTheme>> themes_;
+};
+
+}  // namespace waybar::modules::SNI
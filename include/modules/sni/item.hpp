@@ -11,7 +11,9 @@
 #include <libdbusmenu-gtk/dbusmenu-gtk.h>
 #include <sigc++/trackable.h>
 
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <set>
 #include <string_view>
 
@@ -46,7 +48,8 @@ class Item : public sigc::trackable {
   std::string title;
   std::string icon_name;
   Glib::RefPtr<Gdk::Pixbuf> icon_pixmap;
-  Glib::RefPtr<Gtk::IconTheme> icon_theme;
+  // Shared with the items using the same IconThemePath, see IconThemeRegistry
+  std::shared_ptr<Gtk::IconTheme> icon_theme;
   std::string overlay_icon_name;
   Glib::RefPtr<Gdk::Pixbuf> overlay_icon_pixmap;
   std::string attention_icon_name;
@@ -73,12 +76,15 @@ class Item : public sigc::trackable {
   void invalidate();
   void setCustomIcon(const std::string& id);
   void getUpdatedProperties();
-  void processUpdatedProperties(Glib::RefPtr<Gio::AsyncResult>& result);
+  void processUpdatedProperty(Glib::RefPtr<Gio::AsyncResult>& result, const Glib::ustring& name,
+                              const std::shared_ptr<size_t>& remaining);
   void onSignal(const Glib::ustring& sender_name, const Glib::ustring& signal_name,
                 const Glib::VariantContainerBase& arguments);
 
   void updateImage();
-  static Glib::RefPtr<Gdk::Pixbuf> extractPixBuf(GVariant* variant);
+  Glib::RefPtr<Gdk::Pixbuf> extractPixBuf(GVariant* variant, uint64_t& hash,
+                                          const Glib::RefPtr<Gdk::Pixbuf>& current);
+  Glib::RefPtr<Gdk::Pixbuf> scaleToIconSize(const Glib::RefPtr<Gdk::Pixbuf>& pixbuf);
   Glib::RefPtr<Gdk::Pixbuf> getIconPixbuf();
   Glib::RefPtr<Gdk::Pixbuf> getAttentionIconPixbuf();
   Glib::RefPtr<Gdk::Pixbuf> getOverlayIconPixbuf();
@@ -102,6 +108,11 @@ class Item : public sigc::trackable {
   bool show_passive_ = false;
   bool ready_ = false;
   Glib::ustring status_ = "active";
+  // content hashes of the last converted pixmaps, 0 when unset
+  uint64_t icon_pixmap_hash_ = 0;
+  uint64_t overlay_icon_pixmap_hash_ = 0;
+  uint64_t attention_icon_pixmap_hash_ = 0;
+  std::string last_render_key_;
 
   const Bar& bar_;
   const std::function<void(Item&)> on_ready_;
@@ -4,9 +4,12 @@
 #include <gtkmm/icontheme.h>
 #include <libupower-glib/upower.h>
 
+#include <memory>
+#include <set>
 #include <unordered_map>
 
 #include "AIconLabel.hpp"
+#include "util/tooltip_tree.hpp"
 
 namespace waybar::modules {
 
@@ -25,7 +28,8 @@ class UPower final : public AIconLabel {
   int iconSize_{20};
   int tooltip_spacing_{4};
   int tooltip_padding_{4};
-  Gtk::Box contentBox_;  // tooltip box
+  // One row per battery device, kept up to date as devices change
+  std::unique_ptr<util::TooltipTree> tooltip_;
   std::string tooltipFormat_;
 
   // UPower device info
@@ -35,12 +39,13 @@ class UPower final : public AIconLabel {
     double temperature{0.0};
     guint64 time_full{0u};
     guint64 time_empty{0u};
-    gchar* icon_name{(char*)'\0'};
+    // Copied from the device, so the GLib strings are freed right away
+    std::string icon_name;
     bool upDeviceValid{false};
     UpDeviceState state;
     UpDeviceKind kind;
-    char* nativePath{(char*)'\0'};
-    char* model{(char*)'\0'};
+    std::string nativePath;
+    std::string model;
   };
 
   // Technical variables
@@ -60,6 +65,9 @@ class UPower final : public AIconLabel {
   void setDisplayDevice();
   const Glib::ustring getText(const upDevice_output& upDevice_, const std::string& format);
   bool queryTooltipCb(int, int, bool, const Glib::RefPtr<Gtk::Tooltip>&);
+  void deviceChanged(UpDevice*, const gchar* property);
+  void refreshTooltipRows();
+  void updateTooltipRow(const std::string& objectPath, upDevice_output& upDevice);
 
   // DBUS variables
   guint watcherID_;
@@ -72,6 +80,9 @@ class UPower final : public AIconLabel {
   typedef std::unordered_map<std::string, upDevice_output> Devices;
   Devices devices_;
   bool upRunning_{true};
+  // Devices whose tooltip row is refreshed once their burst of notifications is over
+  std::set<std::string> changedDevices_;
+  sigc::connection tooltipRefresh_;
 
   // DBus callbacks
   void getConn_cb(Glib::RefPtr<Gio::AsyncResult>& result);
@@ -7,6 +7,7 @@
 #include <array>
 
 #include "ALabel.hpp"
+#include "util/wireplumber_context.hpp"
 
 namespace waybar::modules {
 
@@ -17,32 +18,24 @@ class Wireplumber : public ALabel {
   auto update() -> void override;
 
  private:
-  void asyncLoadRequiredApiModules();
-  void prepare(waybar::modules::Wireplumber* self);
-  void activatePlugins();
+  void onContextReady();
+  void subscribeNodes();
   static void updateVolume(waybar::modules::Wireplumber* self, uint32_t id);
   static void updateNodeName(waybar::modules::Wireplumber* self, uint32_t id);
   static void updateSourceVolume(waybar::modules::Wireplumber* self, uint32_t id);
   static void updateSourceName(waybar::modules::Wireplumber* self, uint32_t id);  // NEW
-  static void onPluginActivated(WpObject* p, GAsyncResult* res, waybar::modules::Wireplumber* self);
-  static void onDefaultNodesApiLoaded(WpObject* p, GAsyncResult* res,
-                                      waybar::modules::Wireplumber* self);
-  static void onMixerApiLoaded(WpObject* p, GAsyncResult* res, waybar::modules::Wireplumber* self);
-  static void onObjectManagerInstalled(waybar::modules::Wireplumber* self);
   static void onMixerChanged(waybar::modules::Wireplumber* self, uint32_t id);
   static void onDefaultNodesApiChanged(waybar::modules::Wireplumber* self);
 
   bool handleScroll(GdkEventScroll* e) override;
 
-  static std::list<waybar::modules::Wireplumber*> modules;
-
-  WpCore* wp_core_;
-  GPtrArray* apis_;
-  WpObjectManager* om_;
-  WpPlugin* mixer_api_;
-  WpPlugin* def_nodes_api_;
+  // Core, object manager and API plugins shared with every other wireplumber module
+  std::shared_ptr<util::WireplumberContext> context_;
+  sigc::connection ready_connection_;
+  sigc::connection default_nodes_connection_;
+  sigc::connection node_connection_;
+  sigc::connection source_node_connection_;
   gchar* default_node_name_;
-  uint32_t pending_plugins_;
   bool muted_;
   double volume_;
   double min_step_;
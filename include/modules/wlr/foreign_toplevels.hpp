@@ -0,0 +1,107 @@
+#pragma once
+
+#include <giomm/desktopappinfo.h>
+#include <wayland-client.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "wlr-foreign-toplevel-management-unstable-v1-client-protocol.h"
+
+namespace waybar::modules::wlr {
+
+class ForeignToplevels;
+
+/* A toplevel as of the last done event of the compositor */
+struct Toplevel {
+  enum State {
+    MAXIMIZED = (1 << 0),
+    MINIMIZED = (1 << 1),
+    ACTIVE = (1 << 2),
+    FULLSCREEN = (1 << 3),
+  };
+
+  uint32_t id;
+  struct zwlr_foreign_toplevel_handle_v1* handle;
+  // Receives the events of the handle
+  ForeignToplevels* owner;
+  std::string title;
+  std::string app_id;
+  uint32_t state = 0;
+  std::vector<struct wl_output*> outputs;
+  // Whether the compositor finished describing it with a done event
+  bool announced = false;
+  // Set for the last notification about the toplevel
+  bool closed = false;
+
+  bool on_output(struct wl_output* output) const;
+
+  /* Desktop entries, resolved once per toplevel and shared by every taskbar.
+   * Taskbars look up the app_id after their own app_ids-mapping, so entries are kept per id and
+   * dropped when the app_id changes. The title is only looked up for toplevels without an entry.
+   */
+  Glib::RefPtr<Gio::DesktopAppInfo> app_info_for_app_id(const std::string& mapped_app_id) const;
+  Glib::RefPtr<Gio::DesktopAppInfo> app_info_for_title() const;
+
+ private:
+  friend class ForeignToplevels;
+
+  mutable std::map<std::string, Glib::RefPtr<Gio::DesktopAppInfo>> app_infos_;
+  mutable std::optional<std::pair<std::string, Glib::RefPtr<Gio::DesktopAppInfo>>> title_info_;
+};
+
+/* The foreign toplevels of the session, shared by every taskbar of the process.
+ * The manager is bound once and every toplevel is tracked once. Taskbars are told about complete
+ * changes only, after the done event that ends them, and create widgets for the toplevels they
+ * show.
+ */
+class ForeignToplevels {
+ public:
+  using SubscriptionId = uint32_t;
+  using Subscriber = std::function<void(const Toplevel&)>;
+
+ private:
+  struct PrivateConstructorTag {};
+
+  struct zwlr_foreign_toplevel_manager_v1* manager_ = nullptr;
+  // By id, so in the order the toplevels were created
+  std::map<uint32_t, std::unique_ptr<Toplevel>> toplevels_;
+  uint32_t next_id_ = 0;
+  std::map<SubscriptionId, Subscriber> subscribers_;
+  SubscriptionId next_subscription_ = 0;
+
+  void notify(const Toplevel& toplevel);
+  void destroy(Toplevel& toplevel);
+
+ public:
+  static std::shared_ptr<ForeignToplevels> getInstance();
+
+  ForeignToplevels(PrivateConstructorTag tag);
+  ~ForeignToplevels();
+
+  // False if the compositor has no foreign toplevel manager
+  bool available() const { return manager_ != nullptr; }
+
+  // Replays the current toplevels, then reports every change
+  SubscriptionId subscribe(Subscriber subscriber);
+  void unsubscribe(SubscriptionId id);
+
+  /* Callbacks for the wlr protocol, each toplevel handle has its Toplevel as listener data */
+  void handle_toplevel_create(struct zwlr_foreign_toplevel_handle_v1* handle);
+  void handle_finished();
+  void handle_title(Toplevel& toplevel, const char* title);
+  void handle_app_id(Toplevel& toplevel, const char* app_id);
+  void handle_output_enter(Toplevel& toplevel, struct wl_output* output);
+  void handle_output_leave(Toplevel& toplevel, struct wl_output* output);
+  void handle_state(Toplevel& toplevel, struct wl_array* state);
+  void handle_done(Toplevel& toplevel);
+  void handle_closed(Toplevel& toplevel);
+};
+
+}  // namespace waybar::modules::wlr
@@ -19,6 +19,7 @@
 #include "bar.hpp"
 #include "client.hpp"
 #include "giomm/desktopappinfo.h"
+#include "modules/wlr/foreign_toplevels.hpp"
 #include "util/icon_loader.hpp"
 #include "util/json.hpp"
 #include "wlr-foreign-toplevel-management-unstable-v1-client-protocol.h"
@@ -33,25 +34,14 @@ class Taskbar;
 
 class Task {
  public:
-  Task(const waybar::Bar&, const Json::Value&, Taskbar*, struct zwlr_foreign_toplevel_handle_v1*,
-       struct wl_seat*);
+  Task(const waybar::Bar&, const Json::Value&, Taskbar*, const Toplevel&, struct wl_seat*);
   ~Task();
 
  public:
-  enum State {
-    MAXIMIZED = (1 << 0),
-    MINIMIZED = (1 << 1),
-    ACTIVE = (1 << 2),
-    FULLSCREEN = (1 << 3),
-    INVALID = (1 << 4)
-  };
   // made public so TaskBar can reorder based on configuration.
   Gtk::Button button;
   struct widget_geometry minimize_hint;
 
- private:
-  static uint32_t global_id;
-
  private:
   const waybar::Bar& bar_;
   const Json::Value& config_;
@@ -66,8 +56,6 @@ class Task {
   Gtk::Label text_before_;
   Gtk::Label text_after_;
   Glib::RefPtr<Gio::DesktopAppInfo> app_info_;
-  bool button_visible_ = false;
-  bool ignored_ = false;
 
   bool with_icon_ = false;
   bool with_name_ = false;
@@ -78,6 +66,8 @@ class Task {
 
   std::string name_;
   std::string title_;
+  // As sent by the compositor, before the app_ids-mapping is applied
+  std::string raw_app_id_;
   std::string app_id_;
   uint32_t state_ = 0;
 
@@ -90,7 +80,8 @@ class Task {
   std::string state_string(bool = false) const;
   void set_minimize_hint();
   void on_button_size_allocated(Gtk::Allocation& alloc);
-  void hide_if_ignored();
+  void set_title(const Toplevel&);
+  void set_app_id(const Toplevel&);
 
  public:
   /* Getter functions */
@@ -98,20 +89,14 @@ class Task {
   std::string title() const { return title_; }
   std::string app_id() const { return app_id_; }
   uint32_t state() const { return state_; }
-  bool maximized() const { return state_ & MAXIMIZED; }
-  bool minimized() const { return state_ & MINIMIZED; }
-  bool active() const { return state_ & ACTIVE; }
-  bool fullscreen() const { return state_ & FULLSCREEN; }
+  bool maximized() const { return state_ & Toplevel::MAXIMIZED; }
+  bool minimized() const { return state_ & Toplevel::MINIMIZED; }
+  bool active() const { return state_ & Toplevel::ACTIVE; }
+  bool fullscreen() const { return state_ & Toplevel::FULLSCREEN; }
 
  public:
-  /* Callbacks for the wlr protocol */
-  void handle_title(const char*);
-  void handle_app_id(const char*);
-  void handle_output_enter(struct wl_output*);
-  void handle_output_leave(struct wl_output*);
-  void handle_state(struct wl_array*);
-  void handle_done();
-  void handle_closed();
+  // Takes over the changes of the toplevel up to its last done event
+  void handle_changed(const Toplevel&);
 
   /* Callbacks for Gtk events */
   bool handle_clicked(GdkEventButton*);
@@ -149,29 +134,27 @@ class Taskbar : public waybar::AModule {
  private:
   const waybar::Bar& bar_;
   Gtk::Box box_;
+  // Only for the toplevels shown on this bar
   std::vector<TaskPtr> tasks_;
 
   IconLoader icon_loader_;
   std::unordered_set<std::string> ignore_list_;
   std::map<std::string, std::string> app_ids_replace_map_;
 
-  struct zwlr_foreign_toplevel_manager_v1* manager_;
-  struct wl_seat* seat_;
-
- public:
-  /* Callbacks for global registration */
-  void register_manager(struct wl_registry*, uint32_t name, uint32_t version);
-  void register_seat(struct wl_registry*, uint32_t name, uint32_t version);
+  // Shared with the other taskbars
+  std::shared_ptr<ForeignToplevels> toplevels_;
+  ForeignToplevels::SubscriptionId subscription_;
+  // Shared with the other modules
+  std::shared_ptr<struct wl_seat> seat_;
 
-  /* Callbacks for the wlr protocol */
-  void handle_toplevel_create(struct zwlr_foreign_toplevel_handle_v1*);
-  void handle_finished();
+  // Whether the bar shows the toplevel, `shown` if it did so far
+  bool shows(const Toplevel&, bool shown) const;
+  void handle_toplevel(const Toplevel&);
 
  public:
   void add_button(Gtk::Button&);
   void move_button(Gtk::Button&, int);
   void remove_button(Gtk::Button&);
-  void remove_task(uint32_t);
 
   bool show_output(struct wl_output*) const;
   bool all_outputs() const;
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <sigc++/connection.h>
+
+#include <chrono>
+#include <functional>
+
+namespace waybar::util {
+
+/* Runs an action at most once per window.
+ * The first trigger() opens the window; every further trigger() until it closes is folded into
+ * the same run, so the action should read the accumulated state when it runs. A zero window runs
+ * the action on every trigger().
+ */
+class ActionCoalescer {
+ public:
+  ActionCoalescer(std::chrono::milliseconds window, std::function<void()> action);
+  ~ActionCoalescer();
+
+  ActionCoalescer(const ActionCoalescer&) = delete;
+  ActionCoalescer& operator=(const ActionCoalescer&) = delete;
+
+  void trigger();
+  // Runs a pending action right away
+  void flush();
+  bool pending() const { return timer_.connected(); }
+
+ private:
+  std::chrono::milliseconds window_;
+  std::function<void()> action_;
+  sigc::connection timer_;
+};
+
+}  // namespace waybar::util
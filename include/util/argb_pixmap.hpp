@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace waybar::util {
+
+struct PixmapSize {
+  int width;
+  int height;
+};
+
+/* Converts ARGB32 pixels in network byte order, as sent in StatusNotifierItem pixmaps, to the
+ * RGBA byte layout expected by Gdk::Pixbuf. size is in bytes and must be a multiple of 4.
+ * src and dst may point to the same buffer.
+ */
+void argbToRgba(const uint8_t* src, uint8_t* dst, size_t size);
+
+// Non-cryptographic hash of a byte range, used to detect unchanged pixmaps
+uint64_t hashBytes(const uint8_t* data, size_t size, uint64_t seed = 0);
+
+/* Index of the frame that needs the least scaling to be shown target_size pixels high: the
+ * smallest frame at least that high, or the largest frame if all of them are smaller.
+ * Returns -1 if sizes is empty.
+ */
+int selectPixmapFrame(const std::vector<PixmapSize>& sizes, int target_size);
+
+}  // namespace waybar::util
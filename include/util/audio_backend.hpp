@@ -7,22 +7,37 @@
 #include <pulse/volume.h>
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "util/backend_common.hpp"
 
 namespace waybar::util {
 
+// What a module displays; updates of the other side are not delivered to it
+enum class AudioTarget : char { Sink = 1, Source = 2, Both = 3 };
+
+/* The PulseAudio connection of the process.
+ * Every pulseaudio and pulseaudio-slider module on every bar shares one mainloop thread and one
+ * context, so the server sees a single client and introspection requests are not duplicated.
+ */
 class AudioBackend {
+ public:
+  using SubscriptionId = uint32_t;
+
  private:
   static void subscribeCb(pa_context*, pa_subscription_event_type_t, uint32_t, void*);
   static void contextStateCb(pa_context*, void*);
   static void sinkInfoCb(pa_context*, const pa_sink_info*, int, void*);
+  static void sinkListCb(pa_context*, const pa_sink_info*, int, void*);
   static void sourceInfoCb(pa_context*, const pa_source_info* i, int, void* data);
+  static void sourceListCb(pa_context*, const pa_source_info* i, int, void* data);
   static void serverInfoCb(pa_context*, const pa_server_info*, void*);
   static void volumeModifyCb(pa_context*, int, void*);
   void connectContext();
+  void notify(AudioTarget target);
 
   pa_threaded_mainloop* mainloop_;
   pa_mainloop_api* mainloop_api_;
@@ -51,7 +66,19 @@ class AudioBackend {
 
   std::vector<std::string> ignored_sinks_;
 
-  std::function<void()> on_updated_cb_ = NOOP;
+  // Coalesce list requests triggered by bursts of sink-input/source-output events
+  bool sink_list_pending_{false};
+  bool source_list_pending_{false};
+
+  struct Subscriber {
+    AudioTarget target;
+    std::function<void()> on_updated;
+  };
+  // Callbacks run on the mainloop thread while holding this mutex, so unsubscribe() returns only
+  // once no callback of the subscriber can run anymore
+  std::mutex subscribers_mutex_;
+  std::map<SubscriptionId, Subscriber> subscribers_;
+  SubscriptionId next_subscription_{0};
 
   /* Hack to keep constructor inaccessible but still public.
    * This is required to be able to use std::make_shared.
@@ -62,14 +89,19 @@ class AudioBackend {
   struct private_constructor_tag {};
 
  public:
-  static std::shared_ptr<AudioBackend> getInstance(std::function<void()> on_updated_cb = NOOP);
+  static std::shared_ptr<AudioBackend> getInstance();
 
-  AudioBackend(std::function<void()> on_updated_cb, private_constructor_tag tag);
+  explicit AudioBackend(private_constructor_tag tag);
   ~AudioBackend();
 
+  // on_updated is called from the mainloop thread
+  SubscriptionId subscribe(AudioTarget target, std::function<void()> on_updated);
+  void unsubscribe(SubscriptionId id);
+
   void changeVolume(uint16_t volume, uint16_t min_volume = 0, uint16_t max_volume = 100);
   void changeVolume(ChangeType change_type, double step = 1, uint16_t max_volume = 100);
 
+  // Sinks are shared by all modules, so every module's ignored sinks apply to all of them
   void setIgnoredSinks(const Json::Value& config);
 
   std::string getSinkPortName() const { return port_name_; }
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <giomm/desktopappinfo.h>
+#include <giomm/file.h>
+#include <giomm/filemonitor.h>
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace waybar::util {
+
+/* In-memory index of the desktop entries found in the XDG data directories.
+ * Desktop files are indexed once by basename, lowercase basename and StartupWMClass, so that
+ * resolving an app_id is a couple of hash lookups instead of probing every
+ * prefix/folder/suffix combination on disk. The application directories are watched and any
+ * change marks the index dirty; it is rebuilt lazily on the next lookup.
+ */
+class DesktopAppIndex {
+ public:
+  using AppInfo = Glib::RefPtr<Gio::DesktopAppInfo>;
+
+  static DesktopAppIndex& getInstance();
+
+  DesktopAppIndex(const DesktopAppIndex&) = delete;
+  DesktopAppIndex& operator=(const DesktopAppIndex&) = delete;
+
+  // Desktop file whose basename (without ".desktop") matches name, exactly or case-insensitively
+  AppInfo findByName(const std::string& name);
+  AppInfo findByStartupWMClass(const std::string& wm_class);
+
+  // Returns the memoized result for key, calling resolve on a miss.
+  // Memoized results are dropped whenever the index is invalidated.
+  AppInfo memoize(const std::string& key, const std::function<AppInfo()>& resolve);
+
+  void invalidate();
+
+  static std::vector<std::string> searchPrefixes();
+
+ private:
+  DesktopAppIndex();
+
+  void ensureLoaded();
+  void scanPrefix(const std::string& prefix);
+  void watchDirectory(const std::string& dir);
+  void onDirectoryChanged(const Glib::RefPtr<Gio::File>& file,
+                          const Glib::RefPtr<Gio::File>& other_file,
+                          Gio::FileMonitorEvent event_type);
+  AppInfo appInfoFor(const std::string& path);
+
+  static std::string readStartupWMClass(const std::string& path);
+
+  std::mutex mutex_;
+  bool dirty_ = true;
+  uint64_t generation_ = 0;
+
+  std::vector<std::string> prefixes_;
+  std::unordered_map<std::string, std::string> by_name_;
+  std::unordered_map<std::string, std::string> by_lower_name_;
+  std::unordered_map<std::string, std::string> by_wm_class_;
+  std::unordered_map<std::string, std::string> by_lower_wm_class_;
+  std::unordered_map<std::string, AppInfo> app_infos_;
+  std::unordered_map<std::string, AppInfo> resolved_;
+
+  std::vector<Glib::RefPtr<Gio::FileMonitor>> monitors_;
+};
+
+}  // namespace waybar::util
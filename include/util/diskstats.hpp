@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+namespace waybar::util {
+
+// The counters of one /proc/diskstats line, see Documentation/admin-guide/iostats.rst
+struct DiskStats {
+  std::string_view name;
+  uint64_t reads = 0;
+  // Always in units of 512 bytes, whatever the sector size of the device
+  uint64_t read_sectors = 0;
+  uint64_t writes = 0;
+  uint64_t write_sectors = 0;
+  // Milliseconds in which the device had requests in flight
+  uint64_t io_ticks = 0;
+};
+
+namespace detail {
+
+inline std::string_view nextDiskstatsField(std::string_view& line) {
+  auto begin = line.find_first_not_of(' ');
+  if (begin == std::string_view::npos) {
+    line = {};
+    return {};
+  }
+  line.remove_prefix(begin);
+  auto field = line.substr(0, line.find(' '));
+  line.remove_prefix(field.size());
+  return field;
+}
+
+}  // namespace detail
+
+/* Scans the contents of /proc/diskstats in place.
+ * `accept` gets the device name of every line before any counter is parsed, so rejected lines
+ * only cost the search for their name. `fn` gets the counters of accepted lines; the name points
+ * into `contents`. Malformed lines are skipped.
+ */
+template <typename Accept, typename Fn>
+void scanDiskstats(std::string_view contents, Accept&& accept, Fn&& fn) {
+  while (!contents.empty()) {
+    auto line = contents.substr(0, contents.find('\n'));
+    contents.remove_prefix(std::min(line.size() + 1, contents.size()));
+
+    // Major and minor number precede the name
+    std::string_view name;
+    for (int i = 0; i < 3; i++) {
+      name = detail::nextDiskstatsField(line);
+    }
+    if (name.empty() || !accept(name)) {
+      continue;
+    }
+
+    // Newer kernels append discard and flush counters, which are not needed
+    std::array<uint64_t, 10> counters{};
+    size_t parsed = 0;
+    for (; parsed < counters.size(); parsed++) {
+      auto field = detail::nextDiskstatsField(line);
+      auto [ptr, ec] =
+          std::from_chars(field.data(), field.data() + field.size(), counters[parsed]);
+      if (field.empty() || ec != std::errc() || ptr != field.data() + field.size()) {
+        break;
+      }
+    }
+    if (parsed < counters.size()) {
+      continue;
+    }
+    fn(DiskStats{.name = name,
+                 .reads = counters[0],
+                 .read_sectors = counters[2],
+                 .writes = counters[4],
+                 .write_sectors = counters[6],
+                 .io_ticks = counters[9]});
+  }
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cairomm/surface.h>
+#include <gdkmm/pixbuf.h>
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace waybar::util {
+
+struct IconSurfaceKey {
+  std::string name;  // icon name or file path
+  int size;          // pixel size, already multiplied by scale
+  int scale;
+  std::string theme;
+
+  bool operator==(const IconSurfaceKey&) const = default;
+};
+
+struct IconSurfaceKeyHash {
+  size_t operator()(const IconSurfaceKey& key) const;
+};
+
+/* Process-wide cache of icon surfaces shared by every bar.
+ * The same icon requested with the same size, scale and theme is decoded, scaled and converted to
+ * a cairo surface once; later requests get the cached surface. Entries are evicted in LRU order
+ * once the total pixel memory exceeds the configured budget, and the whole cache is dropped when
+ * the default icon theme changes.
+ */
+class IconSurfaceCache {
+ public:
+  using Surface = Cairo::RefPtr<Cairo::Surface>;
+  using Loader = std::function<Glib::RefPtr<Gdk::Pixbuf>()>;
+
+  static IconSurfaceCache& getInstance();
+
+  IconSurfaceCache(const IconSurfaceCache&) = delete;
+  IconSurfaceCache& operator=(const IconSurfaceCache&) = delete;
+
+  /* Returns the cached surface for key, or calls load on a miss. The loaded pixbuf is scaled to
+   * key.size pixels high (keeping its aspect ratio) before conversion. Failed loads are not cached
+   * and return an empty pointer.
+   */
+  Surface get(const IconSurfaceKey& key, const Loader& load);
+
+  void clear();
+  size_t bytes() const;
+  size_t size() const;
+
+ private:
+  IconSurfaceCache();
+
+  struct Entry {
+    IconSurfaceKey key;
+    Surface surface;
+    size_t bytes;
+  };
+
+  void evict();
+
+  mutable std::mutex mutex_;
+  std::list<Entry> lru_;
+  std::unordered_map<IconSurfaceKey, std::list<Entry>::iterator, IconSurfaceKeyHash> index_;
+  size_t bytes_ = 0;
+  // Enough for a few hundred tray and taskbar icons at 2x scale
+  const size_t max_bytes_ = 8 * 1024 * 1024;
+};
+
+}  // namespace waybar::util
@@ -2,6 +2,10 @@
 
 #include <pipewire/pipewire.h>
 
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "util/backend_common.hpp"
@@ -9,7 +13,28 @@
 
 namespace waybar::util::PipewireBackend {
 
+// A change of one screenshare, audio-in or audio-out node
+struct PrivacyNodeChange {
+  enum class Kind {
+    Added,
+    Removed,
+    // The state of the node or the names shown for it changed
+    StateChanged,
+  };
+  Kind kind;
+  // For removed nodes, as last seen
+  PrivacyNode node;
+};
+
+/* The PipeWire connection of every privacy module of the process.
+ * Only nodes of the privacy media classes are bound. Subscribers are told which of them were
+ * added, removed or changed, so parameter churn of audio streams doesn't reach them.
+ */
 class PipewireBackend {
+ public:
+  using SubscriptionId = uint32_t;
+  using Subscriber = std::function<void(const PrivacyNodeChange&)>;
+
  private:
   pw_thread_loop* mainloop_;
   pw_context* context_;
@@ -18,6 +43,15 @@ class PipewireBackend {
   pw_registry* registry_;
   spa_hook registryListener_;
 
+  // Guards the nodes and the subscribers. Subscribers are called while it is held, so
+  // unsubscribe() returns only once no callback of the subscriber can run anymore.
+  std::mutex mutex_;
+  std::unordered_map<uint32_t, PrivacyNodeInfo*> privacy_nodes_;
+  std::map<SubscriptionId, Subscriber> subscribers_;
+  SubscriptionId next_subscription_{0};
+
+  void notify(const PrivacyNodeChange& change);
+
   /* Hack to keep constructor inaccessible but still public.
    * This is required to be able to use std::make_shared.
    * It is important to keep this class only accessible via a reference-counted
@@ -27,17 +61,18 @@ class PipewireBackend {
   struct PrivateConstructorTag {};
 
  public:
-  sigc::signal<void> privacy_nodes_changed_signal_event;
-
-  std::unordered_map<uint32_t, PrivacyNodeInfo*> privacy_nodes;
-  std::mutex mutex_;
-
   static std::shared_ptr<PipewireBackend> getInstance();
 
+  // Replays the current nodes as added, then reports every change. Called from the PipeWire
+  // thread, except for the replay.
+  SubscriptionId subscribe(Subscriber subscriber);
+  void unsubscribe(SubscriptionId id);
+
   // Handlers for PipeWire events
   void handleRegistryEventGlobal(uint32_t id, uint32_t permissions, const char* type,
                                  uint32_t version, const struct spa_dict* props);
   void handleRegistryEventGlobalRemove(uint32_t id);
+  void handleNodeEventInfo(PrivacyNodeInfo* node, const struct pw_node_info* info);
 
   PipewireBackend(PrivateConstructorTag tag);
   ~PipewireBackend();
@@ -15,14 +15,11 @@ enum PrivacyNodeType {
   PRIVACY_NODE_TYPE_AUDIO_OUTPUT
 };
 
-class PrivacyNodeInfo {
- public:
+// What the privacy module shows of a node, copied out of the PipeWire thread with each change
+struct PrivacyNode {
   PrivacyNodeType type = PRIVACY_NODE_TYPE_NONE;
-  uint32_t id;
-  uint32_t client_id;
+  uint32_t id = 0;
   enum pw_node_state state = PW_NODE_STATE_IDLE;
-  std::string media_class;
-  std::string media_name;
   std::string node_name;
   std::string application_name;
   bool is_monitor = false;
@@ -30,17 +27,30 @@ class PrivacyNodeInfo {
   std::string pipewire_access_portal_app_id;
   std::string application_icon_name;
 
+  std::string getName() const;
+  std::string getIconName() const;
+
+  bool operator==(const PrivacyNode&) const = default;
+};
+
+class PrivacyNodeInfo : public PrivacyNode {
+ public:
+  uint32_t client_id;
+  std::string media_class;
+  std::string media_name;
+  // Whether subscribers were told about the node, which happens with its first info event
+  bool announced = false;
+
+  struct pw_proxy* proxy;
   struct spa_hook object_listener;
   struct spa_hook proxy_listener;
 
   void* data;
 
-  std::string getName();
-  std::string getIconName();
-
   // Handlers for PipeWire events
   void handleProxyEventDestroy();
-  void handleNodeEventInfo(const struct pw_node_info* info);
+  // Returns whether anything the privacy module shows changed
+  bool handleNodeEventInfo(const struct pw_node_info* info);
 };
 
 }  // namespace waybar::util::PipewireBackend
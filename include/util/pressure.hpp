@@ -0,0 +1,84 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <sstream>
+#include <string>
+
+namespace waybar::util {
+
+// One line of a /proc/pressure file, averages in percent and the total stall time in μs
+struct Stall {
+  double avg10 = 0;
+  double avg60 = 0;
+  double avg300 = 0;
+  uint64_t total = 0;
+};
+
+struct Pressure {
+  Stall some;
+  // Missing for the cpu resource on older kernels
+  Stall full;
+};
+
+/* Parses the contents of a /proc/pressure file.
+ * Lines other than "some" and "full", fields without a value and values that aren't numbers are
+ * skipped, leaving the affected averages at zero.
+ */
+inline Pressure parsePressure(const std::string& contents) {
+  Pressure pressure;
+  std::istringstream lines(contents);
+  std::string line;
+  while (std::getline(lines, line)) {
+    std::istringstream fields(line);
+    std::string kind;
+    fields >> kind;
+    if (kind != "some" && kind != "full") continue;
+    auto& stall = kind == "full" ? pressure.full : pressure.some;
+    std::string field;
+    while (fields >> field) {
+      auto eq = field.find('=');
+      if (eq == std::string::npos) continue;
+      auto key = field.substr(0, eq);
+      const char* value = field.c_str() + eq + 1;
+      char* end = nullptr;
+      if (key == "total") {
+        auto total = std::strtoull(value, &end, 10);
+        if (end != value && *end == '\0') stall.total = total;
+        continue;
+      }
+      auto avg = std::strtod(value, &end);
+      if (end == value || *end != '\0') continue;
+      if (key == "avg10") {
+        stall.avg10 = avg;
+      } else if (key == "avg60") {
+        stall.avg60 = avg;
+      } else if (key == "avg300") {
+        stall.avg300 = avg;
+      }
+    }
+  }
+  return pressure;
+}
+
+/* The trigger an unprivileged process may register instead of `trigger`.
+ * Without CAP_SYS_RESOURCE the window must be a multiple of two seconds (Linux 6.5+), so it is
+ * rounded up. Returns nullopt if the window already is one or the trigger is malformed.
+ */
+inline std::optional<std::string> unprivilegedTrigger(const std::string& trigger) {
+  constexpr uint64_t UNPRIVILEGED_WINDOW = 2000000;
+  std::istringstream fields(trigger);
+  std::string kind;
+  uint64_t stall = 0;
+  uint64_t window = 0;
+  if (!(fields >> kind >> stall >> window) || window % UNPRIVILEGED_WINDOW == 0) {
+    return std::nullopt;
+  }
+  window = (window / UNPRIVILEGED_WINDOW + 1) * UNPRIVILEGED_WINDOW;
+  return fmt::format("{} {} {}", kind, stall, window);
+}
+
+}  // namespace waybar::util
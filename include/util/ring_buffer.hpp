@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace waybar::util {
+
+/**
+ * Fixed-capacity history of the latest values.
+ *
+ * The storage is allocated once at construction; pushing into a full buffer overwrites the
+ * oldest value instead of allocating. Index 0 is the oldest value still kept.
+ */
+template <typename T>
+class RingBuffer {
+ public:
+  explicit RingBuffer(size_t capacity) : data_(std::max<size_t>(capacity, 1)) {}
+
+  void push(const T& value) {
+    data_[(start_ + size_) % data_.size()] = value;
+    if (size_ < data_.size()) {
+      size_++;
+    } else {
+      start_ = (start_ + 1) % data_.size();
+    }
+  }
+
+  void clear() {
+    start_ = 0;
+    size_ = 0;
+  }
+
+  const T& operator[](size_t index) const { return data_[(start_ + index) % data_.size()]; }
+  const T& back() const { return (*this)[size_ - 1]; }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return data_.size(); }
+  bool empty() const { return size_ == 0; }
+  bool full() const { return size_ == data_.size(); }
+
+ private:
+  std::vector<T> data_;
+  size_t start_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <charconv>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+#include "util/scoped_fd.hpp"
+
+namespace waybar::util {
+
+/* A sysfs or procfs file kept open for repeated reads.
+ * Every read starts at offset 0 with pread(), which makes the kernel regenerate the contents, so
+ * a changing value is re-read without another open() or path lookup.
+ */
+class SysfsFile {
+ public:
+  SysfsFile() = default;
+  // Leaves the file closed if it does not exist or can't be opened
+  explicit SysfsFile(const std::filesystem::path& path);
+
+  bool isOpen() const { return fd_.get() != -1; }
+
+  // Whole contents, std::nullopt if the file is closed or the read failed
+  std::optional<std::string> read() const;
+  // Same, into a buffer whose capacity is kept between reads. False if the read failed.
+  bool read(std::string& contents) const;
+  // First line without the line break
+  std::optional<std::string> readLine() const;
+
+  template <typename T>
+  std::optional<T> readNumber() const {
+    static_assert(std::is_integral_v<T>);
+    auto contents = readLine();
+    if (!contents) {
+      return std::nullopt;
+    }
+    const auto* begin = contents->data();
+    const auto* end = begin + contents->size();
+    while (begin != end && *begin == ' ') begin++;
+    T value{};
+    auto [ptr, ec] = std::from_chars(begin, end, value);
+    if (ec != std::errc() || ptr == begin) {
+      return std::nullopt;
+    }
+    return value;
+  }
+
+ private:
+  ScopedFd fd_;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <gtkmm/box.h>
+#include <gtkmm/image.h>
+#include <gtkmm/label.h>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace waybar::util {
+
+/* A custom tooltip kept as one widget tree for the lifetime of a module.
+ * The tree holds one row per key, for instance a device's object path, in key order. A row is a
+ * sequence of cells, each an optional icon followed by a label. Modules update rows when their
+ * data changes; setters skip values that did not change, so only changed labels and icons are
+ * touched and nothing is allocated when a tooltip is queried, which just hands out root().
+ */
+class TooltipTree {
+ public:
+  // Rows are stacked along `orientation`, cells of a row are laid out across it
+  TooltipTree(Gtk::Orientation orientation, int spacing, int icon_size);
+  TooltipTree(const TooltipTree&) = delete;
+  TooltipTree& operator=(const TooltipTree&) = delete;
+
+  Gtk::Box& root() { return root_; }
+  // Shown instead of icons missing from the icon theme
+  void setFallbackIcon(const std::string& name) { fallback_icon_ = name; }
+
+  // The row and cell are created on first use
+  void setIcon(const std::string& key, size_t cell, const std::string& name);
+  void setText(const std::string& key, size_t cell, const Glib::ustring& text);
+  void setMarkup(const std::string& key, size_t cell, const Glib::ustring& markup);
+
+  bool contains(const std::string& key) const { return rows_.contains(key); }
+  void remove(const std::string& key);
+  void clear();
+
+ private:
+  struct Cell {
+    Gtk::Box box;
+    Gtk::Image icon;
+    Gtk::Label label;
+    // As requested, before the fallback
+    std::string icon_name;
+    Glib::ustring text;
+    bool markup = false;
+  };
+
+  struct Row {
+    Gtk::Box box;
+    std::vector<std::unique_ptr<Cell>> cells;
+  };
+
+  Cell& cell(const std::string& key, size_t index);
+  void setLabel(Cell& cell, const Glib::ustring& text, bool markup);
+
+  Gtk::Box root_;
+  const Gtk::Orientation cell_orientation_;
+  const int spacing_;
+  const int icon_size_;
+  std::string fallback_icon_;
+  std::map<std::string, std::unique_ptr<Row>> rows_;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace waybar::util {
+
+/**
+ * Lock-free single-producer/single-consumer handoff of the latest value.
+ *
+ * The producer fills writeBuffer() and publish()es it; the consumer calls consume() on its own
+ * schedule and reads readBuffer() until the next consume(). Neither side ever blocks or
+ * allocates: the three buffers rotate through an atomic index. When the producer publishes again
+ * before the consumer picked up the previous value, that value is overwritten and counted as
+ * dropped.
+ */
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() = default;
+  explicit TripleBuffer(const T& init) : buffers_{init, init, init} {}
+
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  // Producer side
+  T& writeBuffer() { return buffers_[write_]; }
+
+  // Returns true if the previously published value was never consumed
+  bool publish() {
+    auto previous = middle_.exchange(write_ | FRESH, std::memory_order_acq_rel);
+    write_ = previous & INDEX_MASK;
+    published_.fetch_add(1, std::memory_order_relaxed);
+    if ((previous & FRESH) != 0) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+  // Consumer side. Returns false if nothing was published since the last call.
+  bool consume() {
+    if ((middle_.load(std::memory_order_relaxed) & FRESH) == 0) {
+      return false;
+    }
+    read_ = middle_.exchange(read_, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+
+  const T& readBuffer() const { return buffers_[read_]; }
+
+  uint64_t published() const { return published_.load(std::memory_order_relaxed); }
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  static constexpr uint8_t INDEX_MASK = 0x3;
+  static constexpr uint8_t FRESH = 0x4;
+
+  std::array<T, 3> buffers_{};
+  uint8_t write_{0};
+  std::atomic<uint8_t> middle_{1};
+  uint8_t read_{2};
+  std::atomic<uint64_t> published_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace waybar::util
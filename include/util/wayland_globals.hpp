@@ -0,0 +1,76 @@
+#pragma once
+
+#include <wayland-client.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace waybar::util {
+
+/* Globals advertised on the client's registry, recorded once for every module.
+ * Modules bind protocol objects from here instead of creating a registry of their own, which would
+ * cost a blocking roundtrip per module and bar. Objects only used for their requests are shared
+ * and refcounted, objects with events need a listener of their own and are bound per caller.
+ */
+class WaylandGlobals {
+ public:
+  // Forgets all globals; the ones of `registry` are added by its listener
+  void reset(wl_registry* registry);
+  void add(uint32_t name, const char* interface, uint32_t version);
+  void remove(uint32_t name);
+
+  // Advertised version of the first global of `interface`, 0 if there is none
+  uint32_t version(const wl_interface& interface) const;
+
+  /* Binds a new object of the first global of `interface`, owned by the caller.
+   * The version is capped by `max_version` and by the client protocol file. Returns nullptr if the
+   * global is not advertised.
+   */
+  template <typename T>
+  T* bind(const wl_interface& interface, uint32_t max_version = UINT32_MAX) const {
+    return static_cast<T*>(bindGlobal(interface, max_version));
+  }
+
+  /* Returns the shared object of `interface`, binding it on the first request.
+   * Requests resolving to the same version share one object, destroyed with `destroy` once the
+   * last reference is gone. Nobody may add a listener to a shared object.
+   */
+  template <typename T>
+  std::shared_ptr<T> acquire(const wl_interface& interface, uint32_t max_version,
+                             void (*destroy)(T*)) {
+    auto key = std::make_pair(std::string(interface.name), boundVersion(interface, max_version));
+    if (auto object = shared_[key].lock()) {
+      return std::static_pointer_cast<T>(object);
+    }
+    auto* object = bind<T>(interface, max_version);
+    if (object == nullptr) {
+      return nullptr;
+    }
+    auto shared = std::shared_ptr<T>(object, destroy);
+    shared_[key] = shared;
+    return shared;
+  }
+
+ private:
+  struct Global {
+    uint32_t name;
+    std::string interface;
+    uint32_t version;
+  };
+
+  const Global* find(const char* interface) const;
+  // Version an object of `interface` is bound with, 0 if it can't be bound
+  uint32_t boundVersion(const wl_interface& interface, uint32_t max_version) const;
+  void* bindGlobal(const wl_interface& interface, uint32_t max_version) const;
+
+  wl_registry* registry_ = nullptr;
+  // In the order they were advertised
+  std::vector<Global> globals_;
+  std::map<std::pair<std::string, uint32_t>, std::weak_ptr<void>> shared_;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <sigc++/sigc++.h>
+#include <wp/wp.h>
+
+#include <map>
+#include <memory>
+
+namespace waybar::util {
+
+/* One WirePlumber connection for every wireplumber module of the process.
+ * The context owns the core, the object manager and the mixer and default-nodes API plugins.
+ * The object manager tracks nodes of every media class, so any node-type can be looked up.
+ * Modules subscribe to the nodes they display; mixer changes are only dispatched to the
+ * subscribers of the changed node.
+ */
+class WireplumberContext {
+ private:
+  static void onDefaultNodesApiLoaded(WpObject* p, GAsyncResult* res, WireplumberContext* self);
+  static void onMixerApiLoaded(WpObject* p, GAsyncResult* res, WireplumberContext* self);
+  static void onPluginActivated(WpObject* p, GAsyncResult* res, WireplumberContext* self);
+  static void onObjectManagerInstalled(WireplumberContext* self);
+  static void onMixerChanged(WireplumberContext* self, uint32_t id);
+  static void onDefaultNodesApiChanged(WireplumberContext* self);
+
+  void activatePlugins();
+
+  WpCore* wp_core_{nullptr};
+  WpObjectManager* om_{nullptr};
+  GPtrArray* apis_{nullptr};
+  WpPlugin* mixer_api_{nullptr};
+  WpPlugin* def_nodes_api_{nullptr};
+  // Cancels pending loads and activations if the last module goes away before they finish
+  GCancellable* cancellable_{nullptr};
+  uint32_t pending_plugins_{0};
+  bool ready_{false};
+
+  sigc::signal<void()> signal_ready_;
+  sigc::signal<void()> signal_default_nodes_changed_;
+  std::map<uint32_t, sigc::signal<void()>> node_signals_;
+
+  struct private_constructor_tag {};
+
+ public:
+  static std::shared_ptr<WireplumberContext> getInstance();
+
+  explicit WireplumberContext(private_constructor_tag tag);
+  ~WireplumberContext();
+
+  bool ready() const { return ready_; }
+  WpObjectManager* objectManager() const { return om_; }
+  WpPlugin* mixerApi() const { return mixer_api_; }
+  WpPlugin* defaultNodesApi() const { return def_nodes_api_; }
+
+  // Emitted once the object manager is installed and both APIs are usable
+  sigc::signal<void()>& signalReady() { return signal_ready_; }
+  sigc::signal<void()>& signalDefaultNodesChanged() { return signal_default_nodes_changed_; }
+  // Emitted when the volume or mute state of node `id` changes
+  sigc::connection connectNode(uint32_t id, const sigc::slot<void()>& slot);
+};
+
+}  // namespace waybar::util
@@ -10,6 +10,7 @@
 #include <optional>
 
 #include "util/gtk_icon.hpp"
+#include "util/icon_surface_cache.hpp"
 
 namespace waybar {
 
@@ -156,17 +157,23 @@ void AAppIconLabel::updateAppIcon() {
     if (app_icon_name_.empty()) {
       image_.set_visible(false);
     } else if (app_icon_name_.front() == '/') {
-      try {
-        int scaled_icon_size = app_icon_size_ * image_.get_scale_factor();
-        auto pixbuf =
-            Gdk::Pixbuf::create_from_file(app_icon_name_, scaled_icon_size, scaled_icon_size);
-
-        auto surface = Gdk::Cairo::create_surface_from_pixbuf(pixbuf, image_.get_scale_factor(),
-                                                              image_.get_window());
+      int scale = image_.get_scale_factor();
+      int scaled_icon_size = app_icon_size_ * scale;
+      auto surface = util::IconSurfaceCache::getInstance().get(
+          {app_icon_name_, scaled_icon_size, scale, ""}, [&]() -> Glib::RefPtr<Gdk::Pixbuf> {
+            try {
+              return Gdk::Pixbuf::create_from_file(app_icon_name_, scaled_icon_size,
+                                                   scaled_icon_size);
+            } catch (const Glib::Exception& e) {
+              spdlog::warn("Failed to load app icon {}: {}", app_icon_name_,
+                           std::string(e.what()));
+              return {};
+            }
+          });
+      if (surface) {
         image_.set(surface);
         image_.set_visible(true);
-      } catch (const Glib::Exception& e) {
-        spdlog::warn("Failed to load app icon {}: {}", app_icon_name_, std::string(e.what()));
+      } else {
         image_.set_visible(false);
       }
     } else {
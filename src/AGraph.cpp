@@ -0,0 +1,161 @@
+#include "AGraph.hpp"
+
+#include <cairo.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace waybar {
+
+AGraph::AGraph(const Json::Value& config, const std::string& name, const std::string& id,
+               const std::string& format, double max, uint16_t interval, bool ellipsize,
+               bool enable_click, bool enable_scroll)
+    : ALabel(config, name, id, format, interval, ellipsize, enable_click, enable_scroll),
+      max_(resolveMax(config, max)) {
+  const auto& graph = config_["graph"];
+  if (!graph.isObject() && !(graph.isBool() && graph.asBool())) {
+    return;
+  }
+  auto option = [&graph](const char* key) {
+    return graph.isObject() ? graph[key] : Json::Value();
+  };
+
+  size_t samples = option("samples").isUInt() ? option("samples").asUInt() : 30;
+  int column_width = option("column-width").isUInt() ? option("column-width").asInt() : 2;
+  graph_ = std::make_unique<Graph>(samples, std::max(1, column_width));
+
+  auto& area = graph_->area;
+  area.set_name(name);
+  area.get_style_context()->add_class("graph");
+  if (!id.empty()) {
+    area.get_style_context()->add_class(id);
+  }
+  area.set_size_request(static_cast<int>(graph_->samples.capacity()) * graph_->column_width, -1);
+  area.signal_draw().connect(sigc::mem_fun(*this, &AGraph::onDraw));
+
+  event_box_.remove();
+  box_.set_spacing(option("spacing").isInt() ? option("spacing").asInt() : 4);
+  if (option("position").isString() && option("position").asString() == "end") {
+    box_.add(label_);
+    box_.add(area);
+  } else {
+    box_.add(area);
+    box_.add(label_);
+  }
+  event_box_.add(box_);
+}
+
+double AGraph::resolveMax(const Json::Value& config, double max) {
+  const auto& graph_max = config["graph"].isObject() ? config["graph"]["max"] : Json::Value();
+  return graph_max.isNumeric() && graph_max.asDouble() > 0 ? graph_max.asDouble() : max;
+}
+
+void AGraph::pushSample(double value) {
+  if (!graph_) {
+    return;
+  }
+  auto& graph = *graph_;
+  graph.samples.push(std::isfinite(value) ? std::max(0.0, value) : 0.0);
+  if (graph.front && top() == graph.top) {
+    scroll();
+  } else {
+    // Rasterized again with the new range on the next draw
+    graph.front = Cairo::RefPtr<Cairo::ImageSurface>();
+  }
+  graph.area.queue_draw();
+}
+
+std::string AGraph::getState(uint8_t value, bool lesser) {
+  auto state = ALabel::getState(value, lesser);
+  if (graph_ && config_["states"].isObject()) {
+    // Mirror the state classes of the label, so the graph can be colored like it
+    auto context = graph_->area.get_style_context();
+    for (auto it = config_["states"].begin(); it != config_["states"].end(); ++it) {
+      if (it.key().isString() && it.key().asString() != state) {
+        context->remove_class(it.key().asString());
+      }
+    }
+    if (!state.empty()) {
+      context->add_class(state);
+    }
+  }
+  return state;
+}
+
+double AGraph::top() const {
+  if (max_ > 0) {
+    return max_;
+  }
+  const auto& samples = graph_->samples;
+  double largest = 0;
+  for (size_t i = 0; i < samples.size(); i++) {
+    largest = std::max(largest, samples[i]);
+  }
+  if (largest <= 0) {
+    return 1;
+  }
+  // Rounded up to a power of two, so the range rarely changes with every new maximum
+  return std::exp2(std::ceil(std::log2(largest)));
+}
+
+bool AGraph::onDraw(const Cairo::RefPtr<Cairo::Context>& cr) {
+  auto& graph = *graph_;
+  int width = graph.area.get_allocated_width();
+  int height = graph.area.get_allocated_height();
+  int scale = graph.area.get_scale_factor();
+  if (width <= 0 || height <= 0) {
+    return false;
+  }
+  auto color = graph.area.get_style_context()->get_color(graph.area.get_state_flags());
+  if (!graph.front || graph.front->get_width() != width * scale ||
+      graph.front->get_height() != height * scale || graph.color != color) {
+    graph.color = color;
+    rasterize(width, height, scale);
+  }
+  cr->set_source(graph.front, 0, 0);
+  cr->paint();
+  return false;
+}
+
+void AGraph::rasterize(int width, int height, int scale) {
+  auto& graph = *graph_;
+  for (auto* surface : {&graph.front, &graph.back}) {
+    *surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width * scale, height * scale);
+    cairo_surface_set_device_scale((*surface)->cobj(), scale, scale);
+  }
+  graph.scale = scale;
+  graph.top = top();
+  auto cr = Cairo::Context::create(graph.front);
+  for (size_t i = 0; i < graph.samples.size(); i++) {
+    paintColumn(cr, i);
+  }
+}
+
+void AGraph::scroll() {
+  auto& graph = *graph_;
+  // Copy everything one column to the left, the newest column becomes transparent
+  auto cr = Cairo::Context::create(graph.back);
+  cr->set_operator(Cairo::OPERATOR_SOURCE);
+  cr->set_source(graph.front, -graph.column_width, 0);
+  cr->paint();
+  std::swap(graph.front, graph.back);
+  paintColumn(Cairo::Context::create(graph.front), graph.samples.size() - 1);
+}
+
+void AGraph::paintColumn(const Cairo::RefPtr<Cairo::Context>& cr, size_t index) const {
+  const auto& graph = *graph_;
+  // Sizes are in logical pixels, the device scale maps them onto the surface
+  double width = static_cast<double>(graph.front->get_width()) / graph.scale;
+  double height = static_cast<double>(graph.front->get_height()) / graph.scale;
+  double x = width - static_cast<double>(graph.samples.size() - index) * graph.column_width;
+  if (x + graph.column_width <= 0) {
+    return;
+  }
+  double value = std::min(1.0, graph.samples[index] / graph.top) * height;
+  cr->set_source_rgba(graph.color.get_red(), graph.color.get_green(), graph.color.get_blue(),
+                      graph.color.get_alpha());
+  cr->rectangle(x, height - value, graph.column_width, value);
+  cr->fill();
+}
+
+}  // namespace waybar
@@ -3,7 +3,10 @@
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
 
+#include <chrono>
+#include <cstdlib>
 #include <util/command.hpp>
+#include <utility>
 
 #include "gdk/gdk.h"
 #include "gdkmm/cursor.h"
@@ -17,7 +20,12 @@ AModule::AModule(const Json::Value& config, const std::string& name, const std::
       isTooltip{config_["tooltip"].isBool() ? config_["tooltip"].asBool() : true},
       isExpand{config_["expand"].isBool() ? config_["expand"].asBool() : false},
       distance_scrolled_y_(0.0),
-      distance_scrolled_x_(0.0) {
+      distance_scrolled_x_(0.0),
+      scroll_coalescer_(coalescingWindow(), [this] {
+        auto steps = scroll_steps_;
+        scroll_steps_ = {};
+        handleScrollSteps(steps);
+      }) {
   // Configure module action Map
   const Json::Value actions{config_["actions"]};
 
@@ -258,27 +266,71 @@ AModule::SCROLL_DIR AModule::getScrollDir(GdkEventScroll* e) {
   }
 }
 
+void AModule::queueScroll(SCROLL_DIR dir) {
+  switch (dir) {
+    case SCROLL_DIR::UP:
+      scroll_steps_.vertical++;
+      break;
+    case SCROLL_DIR::DOWN:
+      scroll_steps_.vertical--;
+      break;
+    case SCROLL_DIR::RIGHT:
+      scroll_steps_.horizontal++;
+      break;
+    case SCROLL_DIR::LEFT:
+      scroll_steps_.horizontal--;
+      break;
+    case SCROLL_DIR::NONE:
+      return;
+  }
+  scroll_coalescer_.trigger();
+}
+
 bool AModule::handleScroll(GdkEventScroll* e) {
-  auto dir = getScrollDir(e);
-  std::string eventName{};
-
-  if (dir == SCROLL_DIR::UP)
-    eventName = "on-scroll-up";
-  else if (dir == SCROLL_DIR::DOWN)
-    eventName = "on-scroll-down";
-  else if (dir == SCROLL_DIR::LEFT)
-    eventName = "on-scroll-left";
-  else if (dir == SCROLL_DIR::RIGHT)
-    eventName = "on-scroll-right";
-
-  // First call module actions
-  this->AModule::doAction(eventName);
-  // Second call user scripts
-  if (config_[eventName].isString())
-    pid_children_.push_back(util::command::forkExec(config_[eventName].asString()));
+  queueScroll(getScrollDir(e));
+  return true;
+}
+
+void AModule::handleScrollSteps(const ScrollSteps& steps) {
+  const std::pair<int, const char*> events[] = {
+      {steps.vertical, steps.vertical > 0 ? "on-scroll-up" : "on-scroll-down"},
+      {steps.horizontal, steps.horizontal > 0 ? "on-scroll-right" : "on-scroll-left"},
+  };
+
+  for (const auto& [count, eventName] : events) {
+    if (count == 0) continue;
+    const int repeat = std::abs(count);
+
+    // First call module actions
+    for (int i = 0; i < repeat; i++) {
+      this->AModule::doAction(eventName);
+    }
+    // Second call user scripts. A command using {steps} runs once for the whole window.
+    if (config_[eventName].isString()) {
+      auto command = config_[eventName].asString();
+      if (auto pos = command.find("{steps}"); pos != std::string::npos) {
+        do {
+          command.replace(pos, 7, std::to_string(repeat));
+          pos = command.find("{steps}", pos);
+        } while (pos != std::string::npos);
+        pid_children_.push_back(util::command::forkExec(command));
+      } else {
+        for (int i = 0; i < repeat; i++) {
+          pid_children_.push_back(util::command::forkExec(command));
+        }
+      }
+    }
+  }
 
   dp.emit();
-  return true;
+}
+
+// One frame at 60Hz unless configured otherwise
+std::chrono::milliseconds AModule::coalescingWindow() const {
+  if (config_["coalescing-window"].isUInt()) {
+    return std::chrono::milliseconds(config_["coalescing-window"].asUInt());
+  }
+  return std::chrono::milliseconds(16);
 }
 
 bool AModule::tooltipEnabled() const { return isTooltip; }
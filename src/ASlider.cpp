@@ -8,14 +8,14 @@ namespace waybar {
 ASlider::ASlider(const Json::Value& config, const std::string& name, const std::string& id)
     : AModule(config, name, id, false, false),
       vertical_(config_["orientation"].asString() == "vertical"),
-      scale_(vertical_ ? Gtk::ORIENTATION_VERTICAL : Gtk::ORIENTATION_HORIZONTAL) {
+      scale_(vertical_ ? Gtk::ORIENTATION_VERTICAL : Gtk::ORIENTATION_HORIZONTAL),
+      value_coalescer_(coalescingWindow(), [this] { onValueChanged(); }) {
   scale_.set_name(name);
   if (!id.empty()) {
     scale_.get_style_context()->add_class(id);
   }
   scale_.get_style_context()->add_class(MODULE_CLASS);
   event_box_.add(scale_);
-  scale_.signal_value_changed().connect(sigc::mem_fun(*this, &ASlider::onValueChanged));
 
   if (config_["min"].isUInt()) {
     min_ = config_["min"].asUInt();
@@ -28,8 +28,17 @@ ASlider::ASlider(const Json::Value& config, const std::string& name, const std::
   scale_.set_inverted(vertical_);
   scale_.set_draw_value(false);
   scale_.set_adjustment(Gtk::Adjustment::create(curr_, min_, max_ + 1, 1, 1, 1));
+
+  // Dragging emits a change per pointer motion, only the value at the end of a window is applied
+  value_changed_ = scale_.signal_value_changed().connect([this] { value_coalescer_.trigger(); });
 }
 
 void ASlider::onValueChanged() {}
 
+void ASlider::setValue(double value) {
+  value_changed_.block();
+  scale_.set_value(value);
+  value_changed_.unblock();
+}
+
 }  // namespace waybar
\ No newline at end of file
@@ -20,6 +20,7 @@ waybar::Client* waybar::Client::inst() {
 void waybar::Client::handleGlobal(void* data, struct wl_registry* registry, uint32_t name,
                                   const char* interface, uint32_t version) {
   auto* client = static_cast<Client*>(data);
+  client->globals.add(name, interface, version);
 
   if (strcmp(interface, zxdg_output_manager_v1_interface.name) == 0 &&
       version >= ZXDG_OUTPUT_V1_NAME_SINCE_VERSION) {
@@ -44,7 +45,7 @@ void waybar::Client::handleGlobal(void* data, struct wl_registry* registry, uint
 
 void waybar::Client::handleGlobalRemove(void* data, struct wl_registry* /*registry*/,
                                         uint32_t name) {
-  // Nothing here
+  static_cast<Client*>(data)->globals.remove(name);
 }
 
 void waybar::Client::handleOutput(struct waybar_output& output) {
@@ -221,7 +222,12 @@ auto waybar::Client::setupCss(const std::string& css_file) -> void {
 }
 
 void waybar::Client::bindInterfaces() {
+  if (registry != nullptr) {
+    // Left over from before a reload, its globals would be added twice
+    wl_registry_destroy(registry);
+  }
   registry = wl_display_get_registry(wl_display);
+  globals.reset(registry);
   static const struct wl_registry_listener registry_listener = {
       .global = handleGlobal,
       .global_remove = handleGlobalRemove,
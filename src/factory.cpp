@@ -49,9 +49,14 @@
 #if defined(__FreeBSD__) || defined(__linux__)
 #include "modules/battery.hpp"
 #endif
+#if defined(__linux__)
+#include "modules/diskio.hpp"
+#include "modules/psi.hpp"
+#endif
 #if defined(HAVE_CPU_LINUX) || defined(HAVE_CPU_BSD)
 #include "modules/cpu.hpp"
 #include "modules/cpu_frequency.hpp"
+#include "modules/cpu_heatmap.hpp"
 #include "modules/cpu_usage.hpp"
 #include "modules/load.hpp"
 #endif
@@ -256,12 +261,23 @@ waybar::AModule* waybar::Factory::makeModule(const std::string& name,
       return new waybar::modules::CpuFrequency(id, config_[name]);
     }
 #endif
+    if (ref == "cpu_heatmap") {
+      return new waybar::modules::CpuHeatmap(id, config_[name]);
+    }
     if (ref == "cpu_usage") {
       return new waybar::modules::CpuUsage(id, config_[name]);
     }
     if (ref == "load") {
       return new waybar::modules::Load(id, config_[name]);
     }
+#endif
+#if defined(__linux__)
+    if (ref == "diskio") {
+      return new waybar::modules::Diskio(id, config_[name]);
+    }
+    if (ref == "psi") {
+      return new waybar::modules::Psi(id, config_[name]);
+    }
 #endif
     if (ref == "clock") {
       return new waybar::modules::Clock(id, config_[name]);
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <memory>
 
 #include "util/backend_common.hpp"
@@ -90,31 +91,23 @@ bool waybar::modules::Backlight::handleScroll(GdkEventScroll* e) {
     return true;
   }
 
-  // Check scroll direction
-  auto dir = AModule::getScrollDir(e);
-
-  // No worries, it will always be set because of the switch below. This is purely to suppress a
-  // warning
-  util::ChangeType ct = util::ChangeType::Increase;
-
-  switch (dir) {
-    case SCROLL_DIR::UP:
-      [[fallthrough]];
-    case SCROLL_DIR::RIGHT:
-      ct = util::ChangeType::Increase;
-      break;
-
-    case SCROLL_DIR::DOWN:
-      [[fallthrough]];
-    case SCROLL_DIR::LEFT:
-      ct = util::ChangeType::Decrease;
-      break;
-
-    case SCROLL_DIR::NONE:
-      return true;
-      break;
+  queueScroll(AModule::getScrollDir(e));
+  return true;
+}
+
+void waybar::modules::Backlight::handleScrollSteps(const ScrollSteps& steps) {
+  if (config_["on-scroll-up"].isString() || config_["on-scroll-down"].isString()) {
+    AModule::handleScrollSteps(steps);
+    return;
   }
 
+  // Up and right increase the brightness, a whole window of steps is applied as one change
+  const int net = steps.vertical + steps.horizontal;
+  if (net == 0) {
+    return;
+  }
+  util::ChangeType ct = net > 0 ? util::ChangeType::Increase : util::ChangeType::Decrease;
+
   // Get scroll step
   double step = 1;
 
@@ -128,9 +121,7 @@ bool waybar::modules::Backlight::handleScroll(GdkEventScroll* e) {
   }
   if (backend.get_scaled_brightness(preferred_device_) <= min_brightness &&
       ct == util::ChangeType::Decrease) {
-    return true;
+    return;
   }
-  backend.set_brightness(preferred_device_, ct, step);
-
-  return true;
+  backend.set_brightness(preferred_device_, ct, step * std::abs(net));
 }
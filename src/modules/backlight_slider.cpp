@@ -11,8 +11,12 @@ BacklightSlider::BacklightSlider(const std::string& id, const Json::Value& confi
       backend(interval_, [this] { this->dp.emit(); }) {}
 
 void BacklightSlider::update() {
+  // Don't move the slider away from a value the user is still setting
+  if (value_coalescer_.pending()) {
+    return;
+  }
   uint16_t brightness = backend.get_scaled_brightness(preferred_device_);
-  scale_.set_value(brightness);
+  setValue(brightness);
 }
 
 void BacklightSlider::onValueChanged() {
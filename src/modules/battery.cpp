@@ -2,6 +2,11 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 
 #include "util/command.hpp"
 #if defined(__FreeBSD__)
@@ -10,12 +15,17 @@
 #include <libudev.h>
 #include <poll.h>
 #include <spdlog/spdlog.h>
-#include <sys/signalfd.h>
+
+// poll() takes an int, intervals beyond it (such as "once") wait for events only
+static int toPollTimeout(std::chrono::milliseconds interval) {
+  return interval.count() > std::numeric_limits<int>::max() ? -1 : interval.count();
+}
 
 waybar::modules::Battery::Battery(const std::string& id, const Bar& bar, const Json::Value& config)
     : ALabel(config, "battery", id, "{capacity}%", 60), last_event_(""), bar_(bar) {
+  poll_timeout_ms_ = toPollTimeout(interval_);
 #if defined(__linux__)
-  battery_watch_fd_ = inotify_init1(IN_CLOEXEC);
+  battery_watch_fd_.reset(inotify_init1(IN_CLOEXEC));
   if (battery_watch_fd_ == -1) {
     throw std::runtime_error("Unable to listen batteries.");
   }
@@ -34,72 +44,127 @@ waybar::modules::Battery::Battery(const std::string& id, const Bar& bar, const J
   udev_monitor_enable_receiving(mon_.get());
 
   if (config_["weighted-average"].isBool()) weightedAverage_ = config_["weighted-average"].asBool();
+  refreshBatteries();
 #endif
   spdlog::debug("battery: worker interval is {}", interval_.count());
   worker();
+  dp.emit();
 }
 
-waybar::modules::Battery::~Battery() {
-#if defined(__linux__)
-  std::lock_guard<std::mutex> guard(battery_list_mutex_);
-
-  for (auto it = batteries_.cbegin(), next_it = it; it != batteries_.cend(); it = next_it) {
-    ++next_it;
-    auto watch_id = (*it).second;
-    if (watch_id >= 0) {
-      inotify_rm_watch(battery_watch_fd_, watch_id);
-    }
-    batteries_.erase(it);
-  }
-  close(battery_watch_fd_);
-#endif
-}
+// The worker thread is stopped first, then the descriptors it polls are closed
+waybar::modules::Battery::~Battery() = default;
 
 void waybar::modules::Battery::worker() {
 #if defined(__FreeBSD__)
-  thread_timer_ = [this] {
+  thread_ = [this] {
     dp.emit();
-    thread_timer_.sleep_for(interval_);
+    thread_.sleep_for(interval_);
   };
 #else
-  thread_timer_ = [this] {
-    // Make sure we eventually update the list of batteries even if we miss an
-    // inotify event for some reason
-    refreshBatteries();
-    dp.emit();
-    thread_timer_.sleep_for(interval_);
-  };
+  // One thread waits for uevents of the power supplies, for reads of their uevent files and for
+  // the fallback poll, whichever comes first
   thread_ = [this] {
-    struct inotify_event event = {0};
-    int nbytes = read(battery_watch_fd_, &event, sizeof(event));
-    if (nbytes != sizeof(event) || event.mask & IN_IGNORED) {
-      thread_.stop();
-      return;
-    }
-    dp.emit();
-  };
-  thread_battery_update_ = [this] {
-    poll_fds_[0].revents = 0;
-    poll_fds_[0].events = POLLIN;
-    poll_fds_[0].fd = udev_monitor_get_fd(mon_.get());
-    int ret = poll(poll_fds_.data(), poll_fds_.size(), -1);
+    std::array<pollfd, 2> fds{{
+        {.fd = battery_watch_fd_, .events = POLLIN, .revents = 0},
+        {.fd = udev_monitor_get_fd(mon_.get()), .events = POLLIN, .revents = 0},
+    }};
+    int ret = poll(fds.data(), fds.size(), poll_timeout_ms_);
     if (ret < 0) {
-      thread_.stop();
+      if (errno != EINTR) {
+        spdlog::error("battery: poll failed: {}", strerror(errno));
+        thread_.stop();
+      }
       return;
     }
-    if ((poll_fds_[0].revents & POLLIN) != 0) {
-      signalfd_siginfo signal_info;
-      read(poll_fds_[0].fd, &signal_info, sizeof(signal_info));
+    if ((fds[0].revents & POLLIN) != 0) {
+      // Only the wakeup matters, drop the queued events
+      alignas(inotify_event) std::array<char, 4096> buffer;
+      read(battery_watch_fd_, buffer.data(), buffer.size());
+    }
+    if ((fds[1].revents & POLLIN) != 0) {
+      handleUevent();
+    }
+    // Make sure we eventually update the list of batteries even if we miss an
+    // event for some reason
+    if (ret == 0 && interval_ != std::chrono::milliseconds::max() &&
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                              last_refresh_) >= interval_) {
+      refreshBatteries();
     }
-    refreshBatteries();
     dp.emit();
   };
 #endif
 }
 
+void waybar::modules::Battery::handleUevent() {
+#if defined(__linux__)
+  std::unique_ptr<udev_device, util::UdevDeviceDeleter> dev(
+      udev_monitor_receive_device(mon_.get()));
+  if (dev == nullptr) {
+    return;
+  }
+  const char* action = udev_device_get_action(dev.get());
+  if (action != nullptr && strcmp(action, "change") == 0) {
+    // The supply reports changes by itself, see pollInterval()
+    last_uevent_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+  } else {
+    // Supplies come and go
+    refreshBatteries();
+  }
+#endif
+}
+
+/*
+ * How long the worker may sleep when no event arrives.
+ * Supplies that send change uevents are only polled as a safety net. For the others, the module
+ * polls about twice per percent of capacity change, and four times as often within two percent of
+ * a state, so that thresholds are crossed on time while a steady discharge costs little.
+ */
+std::chrono::milliseconds waybar::modules::Battery::pollInterval(uint8_t capacity,
+                                                                 float time_remaining,
+                                                                 const std::string& status) const {
+  using std::chrono::milliseconds;
+  const auto base = interval_;
+  // "once" waits for events only
+  if (base == milliseconds::max() || (status != "discharging" && status != "charging") ||
+      time_remaining == 0) {
+    return base;
+  }
+
+  // Capacity change per hour from the remaining time towards empty or full
+  const float remaining = time_remaining > 0 ? capacity : 100.f - capacity;
+  if (remaining <= 0) {
+    return base;
+  }
+  const float percent_per_hour = remaining / std::fabs(time_remaining);
+  auto interval = milliseconds(static_cast<int64_t>(3600000.f / percent_per_hour / 2));
+
+  const auto now_ms = std::chrono::duration_cast<milliseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+  const auto last_uevent = last_uevent_ms_.load();
+  if (last_uevent >= 0 && now_ms - last_uevent < 4 * interval.count()) {
+    return base;
+  }
+
+  if (config_["states"].isObject()) {
+    for (const auto& state : config_["states"]) {
+      if (state.isUInt() && std::abs(static_cast<int>(state.asUInt()) - capacity) <= 2) {
+        interval /= 4;
+        break;
+      }
+    }
+  }
+  const auto slowest = base > milliseconds::max() / 5 ? base : 5 * base;
+  return std::clamp(interval, std::min(milliseconds(5000), base), slowest);
+}
+
 void waybar::modules::Battery::refreshBatteries() {
 #if defined(__linux__)
   std::lock_guard<std::mutex> guard(battery_list_mutex_);
+  last_refresh_ = std::chrono::steady_clock::now();
   // Mark existing list of batteries as not necessarily found
   std::map<fs::path, bool> check_map;
   for (auto const& bat : batteries_) {
@@ -150,14 +215,22 @@ void waybar::modules::Battery::refreshBatteries() {
                            node.path().string());
               continue;
             }
-            batteries_[node.path()] = wd;
+            auto& files = batteries_[node.path()];
+            files.watch_fd = wd;
+            for (size_t i = 0; i < ATTR_NAMES.size(); i++) {
+              files.attrs[i] = util::SysfsFile(node.path() / ATTR_NAMES[i]);
+            }
           }
         }
       }
       auto adap_defined = config_["adapter"].isString();
       if (((adap_defined && dir_name == config_["adapter"].asString()) || !adap_defined) &&
           (fs::exists(node.path() / "online") || fs::exists(node.path() / "status"))) {
-        adapter_ = node.path();
+        if (adapter_ != node.path()) {
+          adapter_ = node.path();
+          adapter_online_ = util::SysfsFile(adapter_ / "online");
+          adapter_status_ = util::SysfsFile(adapter_ / "status");
+        }
       }
     }
   } catch (fs::filesystem_error& e) {
@@ -176,7 +249,7 @@ void waybar::modules::Battery::refreshBatteries() {
   // Remove any batteries that are no longer present and unwatch them
   for (auto const& check : check_map) {
     if (!check.second) {
-      auto watch_id = batteries_[check.first];
+      auto watch_id = batteries_[check.first].watch_fd;
       if (watch_id >= 0) {
         inotify_rm_watch(battery_watch_fd_, watch_id);
       }
@@ -279,110 +352,70 @@ waybar::modules::Battery::getInfos() {
 
     std::string status = "Unknown";
     for (auto const& item : batteries_) {
-      auto bat = item.first;
-      std::string _status;
+      const auto& files = item.second;
+      // Reads an attribute if the battery has it, values that don't parse read as 0
+      auto readAttr = [&files](Attr attr, auto& value) {
+        const auto& file = files[attr];
+        if (!file.isOpen()) return false;
+        value = file.readNumber<std::remove_reference_t<decltype(value)>>().value_or(0);
+        return true;
+      };
 
       /* Check for adapter status if battery is not available */
-      if (!std::ifstream(bat / "status")) {
-        std::getline(std::ifstream(adapter_ / "status"), _status);
-      } else {
-        std::getline(std::ifstream(bat / "status"), _status);
-      }
+      std::string _status = (files[Attr::Status].isOpen() ? files[Attr::Status].readLine()
+                                                          : adapter_status_.readLine())
+                                .value_or("");
 
       // Some battery will report current and charge in μA/μAh.
       // Scale these by the voltage to get μW/μWh.
 
       uint32_t current_now = 0;
       int32_t _current_now_int = 0;
-      bool current_now_exists = false;
-      if (fs::exists(bat / "current_now")) {
-        current_now_exists = true;
-        std::ifstream(bat / "current_now") >> _current_now_int;
-      } else if (fs::exists(bat / "current_avg")) {
-        current_now_exists = true;
-        std::ifstream(bat / "current_avg") >> _current_now_int;
-      }
+      bool current_now_exists = readAttr(Attr::CurrentNow, _current_now_int) ||
+                                readAttr(Attr::CurrentAvg, _current_now_int);
       // Documentation ABI allows a negative value when discharging, positive
       // value when charging.
       current_now = std::abs(_current_now_int);
 
-      if (fs::exists(bat / "time_to_empty_now")) {
+      if (readAttr(Attr::TimeToEmptyNow, time_to_empty_now)) {
         time_to_empty_now_exists = true;
-        std::ifstream(bat / "time_to_empty_now") >> time_to_empty_now;
       }
 
-      if (fs::exists(bat / "time_to_full_now")) {
+      if (readAttr(Attr::TimeToFullNow, time_to_full_now)) {
         time_to_full_now_exists = true;
-        std::ifstream(bat / "time_to_full_now") >> time_to_full_now;
       }
 
       uint32_t voltage_now = 0;
-      bool voltage_now_exists = false;
-      if (fs::exists(bat / "voltage_now")) {
-        voltage_now_exists = true;
-        std::ifstream(bat / "voltage_now") >> voltage_now;
-      } else if (fs::exists(bat / "voltage_avg")) {
-        voltage_now_exists = true;
-        std::ifstream(bat / "voltage_avg") >> voltage_now;
-      }
+      bool voltage_now_exists =
+          readAttr(Attr::VoltageNow, voltage_now) || readAttr(Attr::VoltageAvg, voltage_now);
 
       uint32_t charge_full = 0;
-      bool charge_full_exists = false;
-      if (fs::exists(bat / "charge_full")) {
-        charge_full_exists = true;
-        std::ifstream(bat / "charge_full") >> charge_full;
-      }
+      bool charge_full_exists = readAttr(Attr::ChargeFull, charge_full);
 
       uint32_t charge_full_design = 0;
-      bool charge_full_design_exists = false;
-      if (fs::exists(bat / "charge_full_design")) {
-        charge_full_design_exists = true;
-        std::ifstream(bat / "charge_full_design") >> charge_full_design;
-      }
+      bool charge_full_design_exists = readAttr(Attr::ChargeFullDesign, charge_full_design);
 
       uint32_t charge_now = 0;
-      bool charge_now_exists = false;
-      if (fs::exists(bat / "charge_now")) {
-        charge_now_exists = true;
-        std::ifstream(bat / "charge_now") >> charge_now;
-      }
+      bool charge_now_exists = readAttr(Attr::ChargeNow, charge_now);
 
       uint32_t power_now = 0;
       int32_t _power_now_int = 0;
-      bool power_now_exists = false;
-      if (fs::exists(bat / "power_now")) {
-        power_now_exists = true;
-        std::ifstream(bat / "power_now") >> _power_now_int;
-      }
+      bool power_now_exists = readAttr(Attr::PowerNow, _power_now_int);
       // Some drivers (example: Qualcomm) exposes use a negative value when
       // discharging, positive value when charging.
       power_now = std::abs(_power_now_int);
 
       uint32_t energy_now = 0;
-      bool energy_now_exists = false;
-      if (fs::exists(bat / "energy_now")) {
-        energy_now_exists = true;
-        std::ifstream(bat / "energy_now") >> energy_now;
-      }
+      bool energy_now_exists = readAttr(Attr::EnergyNow, energy_now);
 
       uint32_t energy_full = 0;
-      bool energy_full_exists = false;
-      if (fs::exists(bat / "energy_full")) {
-        energy_full_exists = true;
-        std::ifstream(bat / "energy_full") >> energy_full;
-      }
+      bool energy_full_exists = readAttr(Attr::EnergyFull, energy_full);
 
       uint32_t energy_full_design = 0;
-      bool energy_full_design_exists = false;
-      if (fs::exists(bat / "energy_full_design")) {
-        energy_full_design_exists = true;
-        std::ifstream(bat / "energy_full_design") >> energy_full_design;
-      }
+      bool energy_full_design_exists = readAttr(Attr::EnergyFullDesign, energy_full_design);
 
       uint16_t cycleCount = 0;
-      if (fs::exists(bat / "cycle_count")) {
-        std::ifstream(bat / "cycle_count") >> cycleCount;
-      }
+      readAttr(Attr::CycleCount, cycleCount);
       if (charge_full_design >= largestDesignCapacity) {
         largestDesignCapacity = charge_full_design;
 
@@ -411,9 +444,8 @@ waybar::modules::Battery::getInfos() {
       } else if (energy_now_exists && energy_full_exists && energy_full != 0) {
         capacity_exists = true;
         capacity = 100 * (uint64_t)energy_now / (uint64_t)energy_full;
-      } else if (fs::exists(bat / "capacity")) {
+      } else if (readAttr(Attr::Capacity, capacity)) {
         capacity_exists = true;
-        std::ifstream(bat / "capacity") >> capacity;
       }
 
       if (!voltage_now_exists) {
@@ -564,10 +596,8 @@ waybar::modules::Battery::getInfos() {
     // Give `Plugged` higher priority over `Not charging`.
     // So in a setting where TLP is used, `Plugged` is shown when the threshold is reached
     if (!adapter_.empty() && (status == "Discharging" || status == "Not charging")) {
-      bool online;
-      std::string current_status;
-      std::ifstream(adapter_ / "online") >> online;
-      std::getline(std::ifstream(adapter_ / "status"), current_status);
+      bool online = adapter_online_.readNumber<int>().value_or(0) != 0;
+      std::string current_status = adapter_status_.readLine().value_or("");
       if (online && current_status != "Discharging") status = "Plugged";
     }
 
@@ -650,10 +680,8 @@ const std::string waybar::modules::Battery::getAdapterStatus(uint8_t capacity) c
   {
 #else
   if (!adapter_.empty()) {
-    bool online;
-    std::string status;
-    std::ifstream(adapter_ / "online") >> online;
-    std::getline(std::ifstream(adapter_ / "status"), status);
+    bool online = adapter_online_.readNumber<int>().value_or(0) != 0;
+    std::string status = adapter_status_.readLine().value_or("");
 #endif
     if (capacity == 100) {
       return "Full";
@@ -701,6 +729,9 @@ auto waybar::modules::Battery::update() -> void {
                          [](char ch) { return ch == ' ' ? '-' : std::tolower(ch); });
   auto format = format_;
   auto state = getState(capacity, true);
+#if defined(__linux__)
+  poll_timeout_ms_ = toPollTimeout(pollInterval(capacity, time_remaining, status));
+#endif
   processEvents(state, status, capacity);
   setBarClass(state);
   auto time_remaining_formatted = formatTimeRemaining(time_remaining);
@@ -0,0 +1,96 @@
+#include "modules/cava/cavaCairo.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+waybar::modules::cava::CavaCairo::CavaCairo(const std::string& id, const Json::Value& config)
+    : AModule(config, "cava", id, false, false),
+      backend_{waybar::modules::cava::CavaBackend::inst(config)},
+      reader_{backend_, area_, [this](const CavaFrame& frame) { onFrame(frame); }} {
+  area_.set_name(name_);
+  if (!id.empty()) {
+    area_.get_style_context()->add_class(id);
+  }
+  area_.get_style_context()->add_class(MODULE_CLASS);
+  if (config_["hide_on_silence"].isBool()) hide_on_silence_ = config_["hide_on_silence"].asBool();
+
+  const auto* prm{backend_->getPrm()};
+  bar_spacing_ = std::max(0, prm->bar_spacing);
+
+  // Set widget length
+  int length{0};
+  if (config_["min-length"].isUInt())
+    length = config_["min-length"].asUInt();
+  else if (config_["max-length"].isUInt())
+    length = config_["max-length"].asUInt();
+  else
+    length = prm->fixedbars * (std::max(1, prm->bar_width) + bar_spacing_);
+  area_.set_size_request(length, -1);
+
+  area_.signal_draw().connect(sigc::mem_fun(*this, &CavaCairo::onDraw));
+  backend_->signal_silence().connect(sigc::mem_fun(*this, &CavaCairo::onSilence));
+  event_box_.add(area_);
+  area_.show();
+  backend_->Update();
+}
+
+auto waybar::modules::cava::CavaCairo::doAction(const std::string& name) -> void {
+  if ((actionMap_[name])) {
+    (this->*actionMap_[name])();
+  } else
+    spdlog::error("Cava. Unsupported action \"{0}\"", name);
+}
+
+// Cava actions
+void waybar::modules::cava::CavaCairo::pause_resume() { backend_->doPauseResume(); }
+
+auto waybar::modules::cava::CavaCairo::onFrame(const CavaFrame& frame) -> void {
+  if (silence_) {
+    area_.get_style_context()->remove_class("silent");
+    if (!area_.get_style_context()->has_class("updated"))
+      area_.get_style_context()->add_class("updated");
+    area_.show();
+    silence_ = false;
+  }
+  area_.queue_draw();
+}
+
+auto waybar::modules::cava::CavaCairo::onSilence() -> void {
+  Glib::signal_idle().connect_once([this]() {
+    reader_.stop();
+    if (!silence_) {
+      if (area_.get_style_context()->has_class("updated"))
+        area_.get_style_context()->remove_class("updated");
+
+      if (hide_on_silence_) area_.hide();
+      silence_ = true;
+      area_.get_style_context()->add_class("silent");
+      area_.queue_draw();
+    }
+  });
+}
+
+bool waybar::modules::cava::CavaCairo::onDraw(const Cairo::RefPtr<Cairo::Context>& cr) {
+  const auto* frame{reader_.frame()};
+  if (silence_ || frame == nullptr || frame->bars_raw.empty()) return false;
+  const auto& bars{frame->bars_raw};
+
+  const double width = area_.get_allocated_width();
+  const double height = area_.get_allocated_height();
+  const double count = bars.size();
+  const double bar_width = std::max(1.0, (width - bar_spacing_ * (count - 1)) / count);
+
+  auto color = area_.get_style_context()->get_color(area_.get_state_flags());
+  cr->set_source_rgba(color.get_red(), color.get_green(), color.get_blue(), color.get_alpha());
+
+  // Collect every bar into one path so that the whole frame is a single fill
+  for (size_t i{0}; i < bars.size(); ++i) {
+    const double bar_height = std::clamp(bars[i], 0.f, 1.f) * height;
+    if (bar_height <= 0) continue;
+    cr->rectangle(i * (bar_width + bar_spacing_), height - bar_height, bar_width, bar_height);
+  }
+  cr->fill();
+
+  return false;
+}
@@ -1,12 +1,15 @@
 #include "modules/cava/cavaGLSL.hpp"
 
+#include <fmt/format.h>
+#include <gtkmm/tooltip.h>
 #include <spdlog/spdlog.h>
 
 #include <fstream>
 
 waybar::modules::cava::CavaGLSL::CavaGLSL(const std::string& id, const Json::Value& config)
     : AModule(config, "cavaGLSL", id, false, false),
-      backend_{waybar::modules::cava::CavaBackend::inst(config)} {
+      backend_{waybar::modules::cava::CavaBackend::inst(config)},
+      reader_{backend_, *this, [this](const CavaFrame& frame) { onFrame(frame); }} {
   set_name(name_);
   if (config_["hide_on_silence"].isBool()) hide_on_silence_ = config_["hide_on_silence"].asBool();
   if (!id.empty()) {
@@ -33,29 +36,34 @@ waybar::modules::cava::CavaGLSL::CavaGLSL(const std::string& id, const Json::Val
 
   set_size_request(length, prm_.sdl_height);
 
-  // Subscribe for changes
-  backend_->signal_audio_raw_update().connect(sigc::mem_fun(*this, &CavaGLSL::onUpdate));
+  if (tooltipEnabled() && config_["tooltip-format"].isString()) {
+    set_has_tooltip(true);
+    signal_query_tooltip().connect(sigc::mem_fun(*this, &CavaGLSL::onQueryTooltip));
+  }
+
   // Subscribe for silence
   backend_->signal_silence().connect(sigc::mem_fun(*this, &CavaGLSL::onSilence));
   event_box_.add(*this);
+  // Frames may already be flowing, the reader only starts on an update signal
+  backend_->Update();
 }
 
-auto waybar::modules::cava::CavaGLSL::onUpdate(const ::cava::audio_raw& input) -> void {
-  Glib::signal_idle().connect_once([this, input]() {
-    m_data_ = std::make_shared<::cava::audio_raw>(input);
-    if (silence_) {
-      get_style_context()->remove_class("silent");
-      if (!get_style_context()->has_class("updated")) get_style_context()->add_class("updated");
-      show();
-      silence_ = false;
-    }
+auto waybar::modules::cava::CavaGLSL::onFrame(const CavaFrame& frame) -> void {
+  frame_dirty_ = true;
+  if (silence_) {
+    get_style_context()->remove_class("silent");
+    if (!get_style_context()->has_class("updated")) get_style_context()->add_class("updated");
+    show();
+    silence_ = false;
+  }
 
-    queue_render();
-  });
+  // Nothing to present while the bar is hidden, the latest frame is drawn once mapped again
+  if (get_mapped()) queue_render();
 }
 
 auto waybar::modules::cava::CavaGLSL::onSilence() -> void {
   Glib::signal_idle().connect_once([this]() {
+    reader_.stop();
     if (!silence_) {
       if (get_style_context()->has_class("updated")) get_style_context()->remove_class("updated");
 
@@ -70,26 +78,73 @@ auto waybar::modules::cava::CavaGLSL::onSilence() -> void {
 }
 
 bool waybar::modules::cava::CavaGLSL::onRender(const Glib::RefPtr<Gdk::GLContext>& context) {
-  if (!m_data_) return true;
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  const auto* frame{reader_.frame()};
+  if (frame == nullptr || silence_) {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    return true;
+  }
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, texture_);
-  glUniform1i(glGetUniformLocation(shaderProgram_, "inputTexture"), 0);
+  const auto start{std::chrono::steady_clock::now()};
+  // The framebuffer GtkGLArea renders into
+  GLint widget_fbo{0};
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &widget_fbo);
+
+  if (frame_dirty_) {
+    frame_dirty_ = false;
+    drawFrame(*frame);
+  }
+
+  const int scale{get_scale_factor()};
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, fbos_[last_fbo_]);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, widget_fbo);
+  glBlitFramebuffer(0, 0, prm_.sdl_width, prm_.sdl_height, 0, 0, get_allocated_width() * scale,
+                    get_allocated_height() * scale, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+  glBindFramebuffer(GL_FRAMEBUFFER, widget_fbo);
 
-  glUniform1fv(uniform_bars_, m_data_->number_of_bars, m_data_->bars_raw);
-  glUniform1fv(uniform_previous_bars_, m_data_->number_of_bars, m_data_->previous_bars_raw);
-  glUniform1i(uniform_bars_count_, m_data_->number_of_bars);
+  updateStats(std::chrono::steady_clock::now() - start);
+  return true;
+}
+
+// Runs the shader once for new bars. Uniforms keep their values between renders, so bar data
+// is only uploaded here.
+void waybar::modules::cava::CavaGLSL::drawFrame(const CavaFrame& frame) {
+  glUniform1fv(uniform_bars_, frame.number_of_bars, frame.bars_raw.data());
+  glUniform1fv(uniform_previous_bars_, frame.number_of_bars, frame.previous_bars_raw.data());
+  glUniform1i(uniform_bars_count_, frame.number_of_bars);
   ++frame_counter;
   glUniform1f(uniform_time_, (frame_counter / backend_->getFrameTimeMilsec().count()) / 1e3);
 
-  //  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  const int target{1 - last_fbo_};
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, textures_[last_fbo_]);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbos_[target]);
+  glViewport(0, 0, prm_.sdl_width, prm_.sdl_height);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   glDrawElements(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_INT, nullptr);
+  last_fbo_ = target;
+}
 
-  glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
-  glDrawElements(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_INT, nullptr);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+void waybar::modules::cava::CavaGLSL::updateStats(std::chrono::steady_clock::duration submit) {
+  ++stats_frames_;
+  stats_submit_ += submit;
+  const auto now{std::chrono::steady_clock::now()};
+  const std::chrono::duration<double> elapsed{now - stats_start_};
+  if (elapsed < 1s) return;
+
+  fps_ = stats_frames_ / elapsed.count();
+  submit_ms_ = std::chrono::duration<double, std::milli>(stats_submit_).count() / stats_frames_;
+  stats_start_ = now;
+  stats_submit_ = {};
+  stats_frames_ = 0;
+  spdlog::debug("{0}. {1:.1f} fps, {2:.3f} ms CPU time submitting GL calls per frame", name_,
+                fps_, submit_ms_);
+}
 
+// The statistics are formatted when a tooltip is shown, never while rendering
+bool waybar::modules::cava::CavaGLSL::onQueryTooltip(int x, int y, bool keyboard_tooltip,
+                                                     const Glib::RefPtr<Gtk::Tooltip>& tooltip) {
+  tooltip->set_text(fmt::format(fmt::runtime(config_["tooltip-format"].asString()),
+                                fmt::arg("fps", fps_), fmt::arg("submit", submit_ms_)));
   return true;
 }
 
@@ -143,25 +198,29 @@ void waybar::modules::cava::CavaGLSL::initGLSL() {
 
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gIBO);
 
-  glGenFramebuffers(1, &fbo_);
-  glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
-
-  // Create a texture to attach the framebuffer
-  glGenTextures(1, &texture_);
-  glBindTexture(GL_TEXTURE_2D, texture_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, prm_.sdl_width, prm_.sdl_height, 0, GL_RGBA,
-               GL_UNSIGNED_BYTE, nullptr);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_, 0);
-
-  // Check is framebuffer is complete
-  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-    spdlog::error("{0}. Framebuffer not complete", name_);
+  glGenFramebuffers(2, fbos_);
+  glGenTextures(2, textures_);
+  for (int i{0}; i < 2; ++i) {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbos_[i]);
+
+    // Create a texture to attach the framebuffer
+    glBindTexture(GL_TEXTURE_2D, textures_[i]);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, prm_.sdl_width, prm_.sdl_height, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures_[i], 0);
+
+    // Check is framebuffer is complete
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+      spdlog::error("{0}. Framebuffer not complete", name_);
+    }
+    glClear(GL_COLOR_BUFFER_BIT);
   }
 
   // Unbind the framebuffer
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glUniform1i(glGetUniformLocation(shaderProgram_, "inputTexture"), 0);
   uniform_bars_ = glGetUniformLocation(shaderProgram_, "bars");
   uniform_previous_bars_ = glGetUniformLocation(shaderProgram_, "previous_bars");
   uniform_bars_count_ = glGetUniformLocation(shaderProgram_, "bars_count");
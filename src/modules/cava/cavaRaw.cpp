@@ -4,12 +4,12 @@
 
 waybar::modules::cava::Cava::Cava(const std::string& id, const Json::Value& config)
     : ALabel(config, "cava", id, "{}", 60, false, false, false),
-      backend_{waybar::modules::cava::CavaBackend::inst(config)} {
+      backend_{waybar::modules::cava::CavaBackend::inst(config)},
+      reader_{backend_, label_, [this](const CavaFrame& frame) { onFrame(frame); }} {
   if (config_["hide_on_silence"].isBool()) hide_on_silence_ = config_["hide_on_silence"].asBool();
   if (config_["format_silent"].isString()) format_silent_ = config_["format_silent"].asString();
 
   ascii_range_ = backend_->getAsciiRange();
-  backend_->signal_update().connect(sigc::mem_fun(*this, &Cava::onUpdate));
   backend_->signal_silence().connect(sigc::mem_fun(*this, &Cava::onSilence));
   backend_->Update();
 }
@@ -23,26 +23,25 @@ auto waybar::modules::cava::Cava::doAction(const std::string& name) -> void {
 
 // Cava actions
 void waybar::modules::cava::Cava::pause_resume() { backend_->doPauseResume(); }
-auto waybar::modules::cava::Cava::onUpdate(const std::string& input) -> void {
-  Glib::signal_idle().connect_once([this, input]() {
-    if (silence_) {
-      silence_ = false;
-      label_.get_style_context()->remove_class("silent");
-      if (!label_.get_style_context()->has_class("updated"))
-        label_.get_style_context()->add_class("updated");
-    }
-    label_text_.clear();
-    for (auto& ch : input)
-      label_text_.append(getIcon((ch > ascii_range_) ? ascii_range_ : ch, "", ascii_range_ + 1));
-
-    label_.set_markup(label_text_);
-    label_.show();
-    ALabel::update();
-  });
+auto waybar::modules::cava::Cava::onFrame(const CavaFrame& frame) -> void {
+  if (silence_) {
+    silence_ = false;
+    label_.get_style_context()->remove_class("silent");
+    if (!label_.get_style_context()->has_class("updated"))
+      label_.get_style_context()->add_class("updated");
+  }
+  label_text_.clear();
+  for (auto& ch : frame.output)
+    label_text_.append(getIcon((ch > ascii_range_) ? ascii_range_ : ch, "", ascii_range_ + 1));
+
+  label_.set_markup(label_text_);
+  label_.show();
+  ALabel::update();
 }
 
 auto waybar::modules::cava::Cava::onSilence() -> void {
   Glib::signal_idle().connect_once([this]() {
+    reader_.stop();
     if (!silence_) {
       if (label_.get_style_context()->has_class("updated"))
         label_.get_style_context()->remove_class("updated");
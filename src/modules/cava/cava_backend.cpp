@@ -2,36 +2,44 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <map>
+
+// Modules with the same configuration (e.g. one per output) share a backend, others get their
+// own one on top of a shared capture
 std::shared_ptr<waybar::modules::cava::CavaBackend> waybar::modules::cava::CavaBackend::inst(
     const Json::Value& config) {
-  static auto* backend = new CavaBackend(config);
-  static std::shared_ptr<CavaBackend> backend_ptr{backend};
-  return backend_ptr;
+  static std::map<std::string, std::weak_ptr<CavaBackend>> backends;
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  auto& entry{backends[Json::writeString(builder, config)]};
+  auto backend{entry.lock()};
+  if (!backend) {
+    backend.reset(new CavaBackend(config));
+    entry = backend;
+  }
+  return backend;
 }
 
 waybar::modules::cava::CavaBackend::CavaBackend(const Json::Value& config) : config_(config) {
-  // Load waybar module config
+  // Load waybar module config. Configuration and plan are built once for the backend lifetime
   loadConfig();
-  // Read audio source trough cava API. Cava orginizes this process via infinity loop
-  read_thread_ = [this] {
-    try {
-      input_source_(&audio_data_);
-    } catch (const std::runtime_error& e) {
-      spdlog::warn("Cava backend. Read source error: {0}", e.what());
-    }
-    read_thread_.sleep_for(fetch_input_delay_);
-    loadConfig();
-  };
+  capture_ = CavaCapture::inst(prm_, fetch_input_delay_);
+  consumer_id_ = capture_->attach();
+  samples_.reserve(capture_->bufferSize());
+  buildPlan(plan_format_);
   // Write outcoming data. Emit signals
   out_thread_ = [this] {
-    doUpdate(false);
+    if (pause_toggles_.exchange(0) % 2 != 0) togglePause();
+    doUpdate(force_update_.exchange(false));
     out_thread_.sleep_for(frame_time_milsec_);
   };
 }
 
 waybar::modules::cava::CavaBackend::~CavaBackend() {
   out_thread_.stop();
-  read_thread_.stop();
+  capture_->detach(consumer_id_);
 
   freeBackend();
 }
@@ -54,25 +62,17 @@ static bool downThreadDelay(std::chrono::milliseconds& delay, std::chrono::secon
   return false;
 }
 
-bool waybar::modules::cava::CavaBackend::isSilence() {
-  for (int i{0}; i < audio_data_.input_buffer_size; ++i) {
-    if (audio_data_.cava_in[i]) {
-      return false;
-    }
-  }
-
-  return true;
-}
+bool waybar::modules::cava::CavaBackend::isSilence() { return capture_->isSilence(); }
 
 int waybar::modules::cava::CavaBackend::getAsciiRange() { return prm_.ascii_range; }
 
 // Process: execute cava
 void waybar::modules::cava::CavaBackend::invoke() {
-  pthread_mutex_lock(&audio_data_.lock);
-  ::cava::cava_execute(audio_data_.cava_in, audio_data_.samples_counter, audio_raw_.cava_out,
+  const auto format{capture_->read(consumer_id_, samples_)};
+  // Only a new source format invalidates the plan
+  if (format != plan_format_ && format.rate != 0) buildPlan(format);
+  ::cava::cava_execute(samples_.data(), static_cast<int>(samples_.size()), audio_raw_.cava_out,
                        plan_);
-  if (audio_data_.samples_counter > 0) audio_data_.samples_counter = 0;
-  pthread_mutex_unlock(&audio_data_.lock);
 }
 
 // Do transformation under raw data
@@ -90,39 +90,67 @@ void waybar::modules::cava::CavaBackend::execute() {
   }
 }
 
+// The suspend state and the thread delays belong to out_thread_, so the toggle is posted to it
 void waybar::modules::cava::CavaBackend::doPauseResume() {
-  pthread_mutex_lock(&audio_data_.lock);
-  if (audio_data_.suspendFlag) {
-    audio_data_.suspendFlag = false;
-    pthread_cond_broadcast(&audio_data_.resumeCond);
-    downThreadDelay(frame_time_milsec_, suspend_silence_delay_);
-  } else {
-    audio_data_.suspendFlag = true;
-    upThreadDelay(frame_time_milsec_, suspend_silence_delay_);
-  }
-  pthread_mutex_unlock(&audio_data_.lock);
+  ++pause_toggles_;
   Update();
 }
 
+void waybar::modules::cava::CavaBackend::togglePause() {
+  suspended_ = !suspended_;
+  if (suspended_)
+    upThreadDelay(frame_time_milsec_, suspend_silence_delay_);
+  else
+    downThreadDelay(frame_time_milsec_, suspend_silence_delay_);
+  capture_->suspend(consumer_id_, suspended_);
+}
+
 waybar::modules::cava::CavaBackend::type_signal_update
 waybar::modules::cava::CavaBackend::signal_update() {
   return m_signal_update_;
 }
 
-waybar::modules::cava::CavaBackend::type_signal_audio_raw_update
-waybar::modules::cava::CavaBackend::signal_audio_raw_update() {
-  return m_signal_audio_raw_;
-}
-
 waybar::modules::cava::CavaBackend::type_signal_silence
 waybar::modules::cava::CavaBackend::signal_silence() {
   return m_signal_silence_;
 }
 
-void waybar::modules::cava::CavaBackend::Update() { doUpdate(true); }
+std::shared_ptr<waybar::modules::cava::CavaFrameSlot>
+waybar::modules::cava::CavaBackend::subscribe() {
+  auto slot{std::make_shared<CavaFrameSlot>()};
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  subscribers_.push_back(slot);
+  return slot;
+}
+
+void waybar::modules::cava::CavaBackend::unsubscribe(const std::shared_ptr<CavaFrameSlot>& slot) {
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  std::erase(subscribers_, slot);
+}
+
+// Frames are only produced on out_thread_, so ask it for a forced one instead of racing it
+void waybar::modules::cava::CavaBackend::Update() {
+  force_update_ = true;
+  out_thread_.wake_up();
+}
+
+void waybar::modules::cava::CavaBackend::publishFrame() {
+  const auto bars{static_cast<size_t>(std::max(0, audio_raw_.number_of_bars))};
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  for (auto& slot : subscribers_) {
+    // Buffers keep their capacity, so this does not allocate once warmed up
+    auto& frame{slot->writeBuffer()};
+    frame.output = output_;
+    frame.number_of_bars = audio_raw_.number_of_bars;
+    frame.bars_raw.assign(audio_raw_.bars_raw, audio_raw_.bars_raw + bars);
+    frame.previous_bars_raw.assign(audio_raw_.previous_bars_raw,
+                                   audio_raw_.previous_bars_raw + bars);
+    slot->publish();
+  }
+}
 
 void waybar::modules::cava::CavaBackend::doUpdate(bool force) {
-  if (audio_data_.suspendFlag && !force) return;
+  if (suspended_ && !force) return;
 
   silence_ = isSilence();
   if (!silence_) sleep_counter_ = 0;
@@ -139,8 +167,8 @@ void waybar::modules::cava::CavaBackend::doUpdate(bool force) {
     if (downThreadDelay(frame_time_milsec_, suspend_silence_delay_)) Update();
     execute();
     if (re_paint_ == 1 || force || prm_.continuous_rendering) {
-      m_signal_update_.emit(output_);
-      m_signal_audio_raw_.emit(audio_raw_);
+      publishFrame();
+      if (force || silence_prev_) m_signal_update_.emit();
     }
   } else {
     if (upThreadDelay(frame_time_milsec_, suspend_silence_delay_)) Update();
@@ -153,19 +181,35 @@ void waybar::modules::cava::CavaBackend::freeBackend() {
   if (plan_ != NULL) {
     cava_destroy(plan_);
     plan_ = NULL;
+    audio_raw_clean(&audio_raw_);
   }
 
-  audio_raw_clean(&audio_raw_);
-  pthread_mutex_lock(&audio_data_.lock);
-  audio_data_.terminate = 1;
-  pthread_mutex_unlock(&audio_data_.lock);
   free_config(&prm_);
-  free(audio_data_.source);
-  free(audio_data_.cava_in);
+}
+
+void waybar::modules::cava::CavaBackend::buildPlan(const CavaCapture::Format& format) {
+  if (plan_ != NULL) {
+    cava_destroy(plan_);
+    plan_ = NULL;
+    audio_raw_clean(&audio_raw_);
+    spdlog::debug("cava backend. Source format changed to {0} Hz, {1} channels", format.rate,
+                  format.channels);
+  }
+  plan_format_ = format;
+
+  auto const output{prm_.output};
+  prm_.output = ::cava::output_method::OUTPUT_RAW;
+
+  // Init cava plan, audio_raw structure
+  audio_raw_.height = prm_.ascii_range;
+  capture_->initPlan(&audio_raw_, &prm_, &plan_);
+  if (!plan_) spdlog::error("cava backend plan is not provided");
+  audio_raw_.previous_frame[0] = -1;  // For first Update() call need to rePaint text message
+
+  prm_.output = output;
 }
 
 void waybar::modules::cava::CavaBackend::loadConfig() {
-  freeBackend();
   // Load waybar module config
   char cfgPath[PATH_MAX];
   cfgPath[0] = '\0';
@@ -181,7 +225,6 @@ void waybar::modules::cava::CavaBackend::loadConfig() {
 
   // Override cava parameters by the user config
   prm_.inAtty = 0;
-  auto const output{prm_.output};
   // prm_.output = ::cava::output_method::OUTPUT_RAW;
   if (prm_.data_format) free(prm_.data_format);
   // Default to ascii for format-icons output; allow user override
@@ -238,33 +281,6 @@ void waybar::modules::cava::CavaBackend::loadConfig() {
     prm_.gradient_count = config_["gradient_count"].asInt();
   if (config_["sdl_width"].isInt()) prm_.sdl_width = config_["sdl_width"].asInt();
   if (config_["sdl_height"].isInt()) prm_.sdl_height = config_["sdl_height"].asInt();
-
-  audio_raw_.height = prm_.ascii_range;
-  audio_data_.format = -1;
-  audio_data_.rate = 0;
-  audio_data_.samples_counter = 0;
-  audio_data_.channels = 2;
-  audio_data_.IEEE_FLOAT = 0;
-  audio_data_.input_buffer_size = BUFFER_SIZE * audio_data_.channels;
-  audio_data_.cava_buffer_size = audio_data_.input_buffer_size * 8;
-  audio_data_.terminate = 0;
-  audio_data_.suspendFlag = false;
-  input_source_ = get_input(&audio_data_, &prm_);
-
-  if (!input_source_) {
-    spdlog::error("cava backend API didn't provide input audio source method");
-    exit(EXIT_FAILURE);
-  }
-
-  prm_.output = ::cava::output_method::OUTPUT_RAW;
-
-  // Make cava parameters configuration
-  // Init cava plan, audio_raw structure
-  audio_raw_init(&audio_data_, &audio_raw_, &prm_, &plan_);
-  if (!plan_) spdlog::error("cava backend plan is not provided");
-  audio_raw_.previous_frame[0] = -1;  // For first Update() call need to rePaint text message
-
-  prm_.output = output;
 }
 
 const struct ::cava::config_params* waybar::modules::cava::CavaBackend::getPrm() { return &prm_; }
@@ -0,0 +1,158 @@
+#include "modules/cava/cava_capture.hpp"
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+std::shared_ptr<waybar::modules::cava::CavaCapture> waybar::modules::cava::CavaCapture::inst(
+    struct ::cava::config_params& prm, std::chrono::seconds fetch_input_delay) {
+  static std::map<std::string, std::weak_ptr<CavaCapture>> captures;
+
+  auto key{fmt::format("{}:{}:{}:{}", static_cast<int>(prm.input),
+                       prm.audio_source ? prm.audio_source : "", prm.samplerate, prm.samplebits)};
+  auto& entry{captures[key]};
+  auto capture{entry.lock()};
+  if (!capture) {
+    capture.reset(new CavaCapture(prm, fetch_input_delay));
+    entry = capture;
+    spdlog::debug("cava capture. Opened {0}", key);
+  }
+  return capture;
+}
+
+waybar::modules::cava::CavaCapture::CavaCapture(struct ::cava::config_params& prm,
+                                                std::chrono::seconds fetch_input_delay)
+    : fetch_input_delay_{fetch_input_delay} {
+  audio_data_.format = -1;
+  audio_data_.rate = 0;
+  audio_data_.samples_counter = 0;
+  audio_data_.channels = 2;
+  audio_data_.IEEE_FLOAT = 0;
+  audio_data_.input_buffer_size = BUFFER_SIZE * audio_data_.channels;
+  audio_data_.cava_buffer_size = audio_data_.input_buffer_size * 8;
+  audio_data_.terminate = 0;
+  audio_data_.suspendFlag = false;
+  input_source_ = get_input(&audio_data_, &prm);
+  // What get_input() chose for the source, every attempt starts from it
+  input_format_ = audio_data_.format;
+  input_rate_ = audio_data_.rate;
+
+  if (!input_source_) {
+    spdlog::error("cava backend API didn't provide input audio source method");
+    exit(EXIT_FAILURE);
+  }
+
+  // Read audio source trough cava API. Cava orginizes this process via infinity loop.
+  // When the source goes away the same input is retried, nothing is reallocated.
+  read_thread_ = [this] {
+    // Start every attempt from a clean state, the input may have stopped itself or changed format
+    pthread_mutex_lock(&audio_data_.lock);
+    const bool closing{closing_};
+    if (!closing) {
+      audio_data_.terminate = 0;
+      audio_data_.format = input_format_;
+      audio_data_.rate = input_rate_;
+    }
+    pthread_mutex_unlock(&audio_data_.lock);
+    if (!closing) {
+      try {
+        input_source_(&audio_data_);
+      } catch (const std::runtime_error& e) {
+        spdlog::warn("Cava backend. Read source error: {0}", e.what());
+      }
+    }
+    read_thread_.sleep_for(fetch_input_delay_);
+  };
+}
+
+waybar::modules::cava::CavaCapture::~CavaCapture() {
+  pthread_mutex_lock(&audio_data_.lock);
+  closing_ = true;
+  audio_data_.terminate = 1;
+  audio_data_.suspendFlag = false;
+  pthread_cond_broadcast(&audio_data_.resumeCond);
+  pthread_mutex_unlock(&audio_data_.lock);
+  read_thread_.stop();
+
+  free(audio_data_.source);
+  free(audio_data_.cava_in);
+}
+
+waybar::modules::cava::CavaCapture::ConsumerId waybar::modules::cava::CavaCapture::attach() {
+  pthread_mutex_lock(&audio_data_.lock);
+  auto id{next_consumer_++};
+  // Start from the next sample instead of replaying whatever is buffered
+  consumers_[id].offset = audio_data_.samples_counter;
+  pthread_mutex_unlock(&audio_data_.lock);
+  return id;
+}
+
+void waybar::modules::cava::CavaCapture::detach(ConsumerId id) {
+  suspend(id, false);
+  pthread_mutex_lock(&audio_data_.lock);
+  consumers_.erase(id);
+  pthread_mutex_unlock(&audio_data_.lock);
+}
+
+waybar::modules::cava::CavaCapture::Format waybar::modules::cava::CavaCapture::read(
+    ConsumerId id, std::vector<double>& samples) {
+  pthread_mutex_lock(&audio_data_.lock);
+  auto& consumer{consumers_[id]};
+  const int counter{audio_data_.samples_counter};
+  // The input started over after a buffer overflow
+  if (consumer.offset > counter) consumer.offset = 0;
+  samples.assign(audio_data_.cava_in + consumer.offset, audio_data_.cava_in + counter);
+  consumer.offset = counter;
+
+  // Rewind the buffer once every running consumer has seen its content
+  if (std::all_of(consumers_.begin(), consumers_.end(), [counter](const auto& entry) {
+        return entry.second.suspended || entry.second.offset == counter;
+      })) {
+    audio_data_.samples_counter = 0;
+    for (auto& [_, c] : consumers_) c.offset = 0;
+  }
+  auto current{format()};
+  pthread_mutex_unlock(&audio_data_.lock);
+  return current;
+}
+
+void waybar::modules::cava::CavaCapture::suspend(ConsumerId id, bool suspend) {
+  pthread_mutex_lock(&audio_data_.lock);
+  consumers_[id].suspended = suspend;
+  const bool all_suspended{std::all_of(consumers_.begin(), consumers_.end(),
+                                       [](const auto& entry) { return entry.second.suspended; })};
+  if (all_suspended != static_cast<bool>(audio_data_.suspendFlag)) {
+    audio_data_.suspendFlag = all_suspended;
+    if (!all_suspended) pthread_cond_broadcast(&audio_data_.resumeCond);
+  }
+  pthread_mutex_unlock(&audio_data_.lock);
+}
+
+bool waybar::modules::cava::CavaCapture::isSilence() {
+  pthread_mutex_lock(&audio_data_.lock);
+  const bool silence{std::none_of(audio_data_.cava_in,
+                                  audio_data_.cava_in + audio_data_.input_buffer_size,
+                                  [](double sample) { return sample != 0; })};
+  pthread_mutex_unlock(&audio_data_.lock);
+  return silence;
+}
+
+size_t waybar::modules::cava::CavaCapture::bufferSize() const {
+  return audio_data_.cava_buffer_size;
+}
+
+void waybar::modules::cava::CavaCapture::initPlan(struct ::cava::audio_raw* audio_raw,
+                                                  struct ::cava::config_params* prm,
+                                                  struct ::cava::cava_plan** plan) {
+  // audio_raw_init only reads the source format, so work on a snapshot and let the input run
+  pthread_mutex_lock(&audio_data_.lock);
+  auto audio_data{audio_data_};
+  pthread_mutex_unlock(&audio_data_.lock);
+  audio_raw_init(&audio_data, audio_raw, prm, plan);
+}
+
+waybar::modules::cava::CavaCapture::Format waybar::modules::cava::CavaCapture::format() const {
+  return {static_cast<unsigned int>(audio_data_.rate), static_cast<int>(audio_data_.channels),
+          static_cast<int>(audio_data_.format)};
+}
@@ -0,0 +1,50 @@
+#include "modules/cava/cava_frame_reader.hpp"
+
+#include <glibmm/main.h>
+#include <spdlog/spdlog.h>
+
+waybar::modules::cava::CavaFrameReader::CavaFrameReader(std::shared_ptr<CavaBackend> backend,
+                                                        Gtk::Widget& widget,
+                                                        FrameCallback on_frame)
+    : backend_{std::move(backend)},
+      slot_{backend_->subscribe()},
+      widget_{widget},
+      on_frame_{std::move(on_frame)} {
+  // Emitted from the backend thread, only when frames start flowing
+  update_connection_ = backend_->signal_update().connect([this]() {
+    Glib::signal_idle().connect_once(sigc::mem_fun(*this, &CavaFrameReader::start));
+  });
+}
+
+waybar::modules::cava::CavaFrameReader::~CavaFrameReader() {
+  update_connection_.disconnect();
+  stop();
+  backend_->unsubscribe(slot_);
+  spdlog::debug("cava frontend. {0} frames published, {1} dropped", slot_->published(),
+                slot_->dropped());
+}
+
+void waybar::modules::cava::CavaFrameReader::start() {
+  if (tick_id_ != 0) return;
+  tick_id_ = widget_.add_tick_callback(sigc::mem_fun(*this, &CavaFrameReader::onTick));
+  // Don't wait for the first tick if a frame is already there
+  onTick({});
+}
+
+void waybar::modules::cava::CavaFrameReader::stop() {
+  if (tick_id_ == 0) return;
+  widget_.remove_tick_callback(tick_id_);
+  tick_id_ = 0;
+}
+
+const waybar::modules::cava::CavaFrame* waybar::modules::cava::CavaFrameReader::frame() const {
+  return has_frame_ ? &slot_->readBuffer() : nullptr;
+}
+
+bool waybar::modules::cava::CavaFrameReader::onTick(const Glib::RefPtr<Gdk::FrameClock>& clock) {
+  if (slot_->consume()) {
+    has_frame_ = true;
+    on_frame_(slot_->readBuffer());
+  }
+  return true;
+}
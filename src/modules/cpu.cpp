@@ -14,7 +14,7 @@
 #endif
 
 waybar::modules::Cpu::Cpu(const std::string& id, const Json::Value& config)
-    : ALabel(config, "cpu", id, "{usage}%", 10) {
+    : AGraph(config, "cpu", id, "{usage}%", 100, 10) {
   thread_ = [this] {
     dp.emit();
     thread_.sleep_for(interval_);
@@ -29,6 +29,7 @@ auto waybar::modules::Cpu::update() -> void {
 
   auto format = format_;
   auto total_usage = cpu_usage.empty() ? 0 : cpu_usage[0];
+  pushSample(total_usage);
   auto state = getState(total_usage);
   if (!state.empty() && config_["format-" + state].isString()) {
     format = config_["format-" + state].asString();
@@ -68,5 +69,5 @@ auto waybar::modules::Cpu::update() -> void {
   }
 
   // Call parent update
-  ALabel::update();
+  AGraph::update();
 }
@@ -3,8 +3,9 @@
 
 #include "modules/cpu_frequency.hpp"
 
-std::vector<float> waybar::modules::CpuFrequency::parseCpuFrequencies() {
-  std::vector<float> frequencies;
+std::vector<waybar::modules::CpuFrequency::FrequencySample>
+waybar::modules::CpuFrequency::parseCpuFrequencies() {
+  std::vector<FrequencySample> frequencies;
   size_t len;
   int32_t freq;
 
@@ -15,19 +16,19 @@ std::vector<float> waybar::modules::CpuFrequency::parseCpuFrequencies() {
     len = 4;
     snprintf(buffer, 256, "dev.cpu.%u.freq", i);
     if (sysctlbyname(buffer, &freq, &len, NULL, 0) == -1 || len <= 0) break;
-    frequencies.push_back(freq);
+    frequencies.push_back({static_cast<float>(freq)});
     ++i;
   }
 #else
   int getMhz[] = {CTL_HW, HW_CPUSPEED};
   len = sizeof(freq);
   sysctl(getMhz, 2, &freq, &len, NULL, 0);
-  frequencies.push_back((float)freq);
+  frequencies.push_back({(float)freq});
 #endif
 
   if (frequencies.empty()) {
     spdlog::warn("cpu/bsd: parseCpuFrequencies failed, not found in sysctl");
-    frequencies.push_back(NAN);
+    frequencies.push_back({NAN});
   }
 
   return frequencies;
@@ -57,17 +57,25 @@ auto waybar::modules::CpuFrequency::update() -> void {
 }
 
 std::tuple<float, float, float> waybar::modules::CpuFrequency::getCpuFrequency() {
-  std::vector<float> frequencies = CpuFrequency::parseCpuFrequencies();
-  if (frequencies.empty()) {
+  auto samples = CpuFrequency::parseCpuFrequencies();
+  if (samples.empty()) {
     return {0.f, 0.f, 0.f};
   }
-  auto [min, max] = std::minmax_element(std::begin(frequencies), std::end(frequencies));
-  float avg_frequency =
-      std::accumulate(std::begin(frequencies), std::end(frequencies), 0.0) / frequencies.size();
+  auto [min, max] = std::minmax_element(
+      std::begin(samples), std::end(samples),
+      [](const auto& a, const auto& b) { return a.frequency < b.frequency; });
+  // Every CPU counts once towards the average
+  double total = 0;
+  uint32_t cpus = 0;
+  for (const auto& sample : samples) {
+    total += static_cast<double>(sample.frequency) * sample.cpus;
+    cpus += sample.cpus;
+  }
+  float avg_frequency = cpus > 0 ? total / cpus : 0.f;
 
   // Round frequencies with double decimal precision to get GHz
-  float max_frequency = std::ceil(*max / 10.0) / 100.0;
-  float min_frequency = std::ceil(*min / 10.0) / 100.0;
+  float max_frequency = std::ceil(max->frequency / 10.0) / 100.0;
+  float min_frequency = std::ceil(min->frequency / 10.0) / 100.0;
   avg_frequency = std::ceil(avg_frequency / 10.0) / 100.0;
 
   return {max_frequency, min_frequency, avg_frequency};
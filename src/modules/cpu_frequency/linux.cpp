@@ -1,14 +1,83 @@
 #include <filesystem>
+#include <sstream>
 
 #include "modules/cpu_frequency.hpp"
+#include "util/sysfs_file.hpp"
 
-std::vector<float> waybar::modules::CpuFrequency::parseCpuFrequencies() {
+namespace {
+
+namespace fs = std::filesystem;
+
+/*
+ * The cpufreq policies of the system, discovered once.
+ * CPUs of a policy always run at the same frequency, so one scaling_cur_freq per policy is read
+ * instead of one value per CPU. The descriptors are only read with pread(), so the cpu and
+ * cpu_frequency modules can sample from their own threads at the same time.
+ */
+class CpufreqPolicies {
+ public:
+  static const CpufreqPolicies& instance() {
+    static const CpufreqPolicies policies;
+    return policies;
+  }
+
+  bool empty() const { return policies_.empty(); }
+
+  void sample(std::vector<waybar::modules::CpuFrequency::FrequencySample>& out) const;
+
+ private:
+  struct Policy {
+    waybar::util::SysfsFile cur_freq;
+    uint32_t cpus;
+  };
+
+  CpufreqPolicies();
+
+  std::vector<Policy> policies_;
+};
+
+CpufreqPolicies::CpufreqPolicies() {
+  const fs::path cpufreq_dir = "/sys/devices/system/cpu/cpufreq";
+  std::error_code ec;
+  for (const auto& entry : fs::directory_iterator(cpufreq_dir, ec)) {
+    if (entry.path().filename().string().rfind("policy", 0) != 0) {
+      continue;
+    }
+    waybar::util::SysfsFile cur_freq(entry.path() / "scaling_cur_freq");
+    if (!cur_freq.isOpen()) {
+      cur_freq = waybar::util::SysfsFile(entry.path() / "cpuinfo_cur_freq");
+    }
+    // affected_cpus lists the online CPUs of the policy
+    auto affected = waybar::util::SysfsFile(entry.path() / "affected_cpus").readLine();
+    uint32_t cpus = 0;
+    if (affected) {
+      std::istringstream list(*affected);
+      std::string cpu;
+      while (list >> cpu) cpus++;
+    }
+    if (cur_freq.isOpen() && cpus > 0) {
+      policies_.push_back({std::move(cur_freq), cpus});
+    }
+  }
+}
+
+void CpufreqPolicies::sample(
+    std::vector<waybar::modules::CpuFrequency::FrequencySample>& out) const {
+  for (const auto& policy : policies_) {
+    // Fails while every CPU of the policy is offline
+    if (auto khz = policy.cur_freq.readNumber<uint64_t>()) {
+      out.push_back({static_cast<float>(*khz) / 1000, policy.cpus});
+    }
+  }
+}
+
+std::vector<waybar::modules::CpuFrequency::FrequencySample> parseCpuinfo() {
   const std::string file_path_ = "/proc/cpuinfo";
   std::ifstream info(file_path_);
   if (!info.is_open()) {
     throw std::runtime_error("Can't open " + file_path_);
   }
-  std::vector<float> frequencies;
+  std::vector<waybar::modules::CpuFrequency::FrequencySample> frequencies;
   std::string line;
   while (getline(info, line)) {
     if (line.substr(0, 7).compare("cpu MHz") != 0) {
@@ -17,9 +86,27 @@ std::vector<float> waybar::modules::CpuFrequency::parseCpuFrequencies() {
 
     std::string frequency_str = line.substr(line.find(":") + 2);
     float frequency = std::strtol(frequency_str.c_str(), nullptr, 10);
-    frequencies.push_back(frequency);
+    frequencies.push_back({frequency});
   }
   info.close();
+  return frequencies;
+}
+
+}  // namespace
+
+std::vector<waybar::modules::CpuFrequency::FrequencySample>
+waybar::modules::CpuFrequency::parseCpuFrequencies() {
+  std::vector<FrequencySample> frequencies;
+  const auto& policies = CpufreqPolicies::instance();
+  if (!policies.empty()) {
+    policies.sample(frequencies);
+    if (!frequencies.empty()) {
+      return frequencies;
+    }
+  }
+
+  // Without cpufreq, fall back to the frequencies reported in /proc/cpuinfo
+  frequencies = parseCpuinfo();
 
   if (frequencies.size() <= 0) {
     std::string cpufreq_dir = "/sys/devices/system/cpu/cpufreq";
@@ -34,7 +121,7 @@ std::vector<float> waybar::modules::CpuFrequency::parseCpuFrequencies() {
             if (freq.is_open()) {
               getline(freq, freq_value);
               float frequency = std::strtol(freq_value.c_str(), nullptr, 10);
-              frequencies.push_back(frequency / 1000);
+              frequencies.push_back({frequency / 1000});
               freq.close();
             }
           }
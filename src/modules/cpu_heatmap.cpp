@@ -0,0 +1,195 @@
+#include "modules/cpu_heatmap.hpp"
+
+#include <cairo.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+#include "modules/cpu_usage.hpp"
+
+namespace waybar::modules {
+
+CpuHeatmap::CpuHeatmap(const std::string& id, const Json::Value& config)
+    : AModule(config, "cpu_heatmap", id),
+      rows_(config_["rows"].isUInt() ? std::max(1, config_["rows"].asInt()) : 4),
+      cell_size_(config_["cell-size"].isUInt() ? std::max(1, config_["cell-size"].asInt()) : 4),
+      cell_spacing_(config_["cell-spacing"].isUInt() ? config_["cell-spacing"].asInt() : 1),
+      interval_(config_["interval"].isNumeric()
+                    ? std::max(1L, static_cast<long>(config_["interval"].asDouble() * 1000))
+                    : 10000) {
+  if (config_["colors"].isArray()) {
+    for (const auto& value : config_["colors"]) {
+      Gdk::RGBA color;
+      if (value.isString() && color.set(value.asString())) {
+        colors_.push_back(color);
+      } else {
+        spdlog::warn("cpu_heatmap: invalid color {}", value.toStyledString());
+      }
+    }
+  }
+  if (colors_.empty()) {
+    for (const auto* name : {"#4c566a", "#a3be8c", "#ebcb8b", "#d08770", "#bf616a"}) {
+      colors_.emplace_back(name);
+    }
+  }
+
+  area_.set_name(name_);
+  if (!id.empty()) {
+    area_.get_style_context()->add_class(id);
+  }
+  area_.get_style_context()->add_class(MODULE_CLASS);
+  area_.set_valign(Gtk::ALIGN_CENTER);
+  area_.signal_draw().connect(sigc::mem_fun(*this, &CpuHeatmap::onDraw));
+  if (tooltipEnabled()) {
+    // Built for the hovered cell only, instead of a line per core on every tick
+    area_.set_has_tooltip(true);
+    area_.signal_query_tooltip().connect(sigc::mem_fun(*this, &CpuHeatmap::onQueryTooltip));
+  }
+  event_box_.add(area_);
+  area_.show();
+
+  prev_times_ = CpuUsage::parseCpuinfo();
+  resize(prev_times_.empty() ? 0 : prev_times_.size() - 1);
+
+  thread_ = [this] {
+    dp.emit();
+    thread_.sleep_for(interval_);
+  };
+}
+
+auto CpuHeatmap::update() -> void {
+  auto curr_times = CpuUsage::parseCpuinfo();
+  if (curr_times.size() != prev_times_.size()) {
+    // The number of CPUs has changed, eg. due to CPU hotplug
+    resize(curr_times.empty() ? 0 : curr_times.size() - 1);
+    prev_times_ = std::move(curr_times);
+    AModule::update();
+    return;
+  }
+
+  Cairo::RefPtr<Cairo::Context> cr;
+  if (surface_) {
+    cr = Cairo::Context::create(surface_);
+  }
+  // The first entry is the total of all cores
+  for (size_t core = 0; core < buckets_.size(); core++) {
+    auto [curr_idle, curr_total] = curr_times[core + 1];
+    auto [prev_idle, prev_total] = prev_times_[core + 1];
+    uint16_t usage = 0;
+    int bucket = OFFLINE;
+    if (curr_total != 0 && prev_total != 0) {
+      const float delta_idle = curr_idle - prev_idle;
+      const float delta_total = curr_total - prev_total;
+      usage = (delta_total > 0) ? static_cast<uint16_t>(100 * (1 - delta_idle / delta_total)) : 0;
+      bucket = this->bucket(usage);
+    }
+    usage_[core] = usage;
+    if (bucket == buckets_[core]) {
+      continue;
+    }
+    buckets_[core] = bucket;
+    if (cr) {
+      paintCell(cr, core);
+      auto cell = cellArea(core);
+      area_.queue_draw_area(cell.get_x(), cell.get_y(), cell.get_width(), cell.get_height());
+    }
+  }
+  prev_times_ = std::move(curr_times);
+
+  AModule::update();
+}
+
+void CpuHeatmap::resize(size_t cores) {
+  usage_.assign(cores, 0);
+  buckets_.assign(cores, OFFLINE);
+  grid_rows_ = std::clamp<int>(cores, 1, rows_);
+  int columns = std::max<int>(1, (cores + grid_rows_ - 1) / grid_rows_);
+  area_.set_size_request(columns * (cell_size_ + cell_spacing_) - cell_spacing_,
+                         grid_rows_ * (cell_size_ + cell_spacing_) - cell_spacing_);
+  surface_ = Cairo::RefPtr<Cairo::ImageSurface>();
+  area_.queue_draw();
+}
+
+int CpuHeatmap::bucket(uint16_t usage) const {
+  int colors = colors_.size();
+  return std::min(colors - 1, usage * colors / 100);
+}
+
+Gdk::Rectangle CpuHeatmap::cellArea(size_t core) const {
+  // Cores fill the grid column by column
+  int column = core / grid_rows_;
+  int row = core % grid_rows_;
+  return {column * (cell_size_ + cell_spacing_), row * (cell_size_ + cell_spacing_), cell_size_,
+          cell_size_};
+}
+
+bool CpuHeatmap::onDraw(const Cairo::RefPtr<Cairo::Context>& cr) {
+  int width = area_.get_allocated_width();
+  int height = area_.get_allocated_height();
+  int scale = area_.get_scale_factor();
+  if (width <= 0 || height <= 0) {
+    return false;
+  }
+  if (!surface_ || surface_->get_width() != width * scale ||
+      surface_->get_height() != height * scale) {
+    rasterize(width, height, scale);
+  }
+  // GTK clips this to the invalidated cells
+  cr->set_source(surface_, 0, 0);
+  cr->paint();
+  return false;
+}
+
+void CpuHeatmap::rasterize(int width, int height, int scale) {
+  surface_ = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width * scale, height * scale);
+  cairo_surface_set_device_scale(surface_->cobj(), scale, scale);
+  auto cr = Cairo::Context::create(surface_);
+  for (size_t core = 0; core < buckets_.size(); core++) {
+    paintCell(cr, core);
+  }
+}
+
+void CpuHeatmap::paintCell(const Cairo::RefPtr<Cairo::Context>& cr, size_t core) const {
+  auto cell = cellArea(core);
+  cr->save();
+  cr->rectangle(cell.get_x(), cell.get_y(), cell.get_width(), cell.get_height());
+  cr->clip();
+  cr->set_operator(Cairo::OPERATOR_CLEAR);
+  cr->paint();
+  cr->set_operator(Cairo::OPERATOR_OVER);
+  const auto& color = colors_[std::max(0, buckets_[core])];
+  cr->set_source_rgba(color.get_red(), color.get_green(), color.get_blue(), color.get_alpha());
+  if (buckets_[core] == OFFLINE) {
+    // Only the outline of the lowest color
+    cr->set_line_width(1);
+    cr->rectangle(cell.get_x() + 0.5, cell.get_y() + 0.5, cell.get_width() - 1,
+                  cell.get_height() - 1);
+    cr->stroke();
+  } else {
+    cr->paint();
+  }
+  cr->restore();
+}
+
+bool CpuHeatmap::onQueryTooltip(int x, int y, bool /*keyboard_tooltip*/,
+                                const Glib::RefPtr<Gtk::Tooltip>& tooltip) {
+  int column = x / (cell_size_ + cell_spacing_);
+  int row = y / (cell_size_ + cell_spacing_);
+  if (row >= grid_rows_) {
+    return false;
+  }
+  size_t core = column * grid_rows_ + row;
+  if (core >= buckets_.size()) {
+    return false;
+  }
+  if (buckets_[core] == OFFLINE) {
+    tooltip->set_text(fmt::format("Core{}: offline", core));
+  } else {
+    tooltip->set_text(fmt::format("Core{}: {}%", core, usage_[core]));
+  }
+  tooltip->set_tip_area(cellArea(core));
+  return true;
+}
+
+}  // namespace waybar::modules
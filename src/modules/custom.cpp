@@ -149,10 +149,10 @@ void waybar::modules::Custom::handleEvent() {
   }
 }
 
-bool waybar::modules::Custom::handleScroll(GdkEventScroll* e) {
-  auto ret = ALabel::handleScroll(e);
+void waybar::modules::Custom::handleScrollSteps(const ScrollSteps& steps) {
+  // The scroll commands only run once the coalescing window closes
+  ALabel::handleScrollSteps(steps);
   handleEvent();
-  return ret;
 }
 
 bool waybar::modules::Custom::handleToggle(GdkEventButton* const& e) {
@@ -3,7 +3,7 @@
 using namespace waybar::util;
 
 waybar::modules::Disk::Disk(const std::string& id, const Json::Value& config)
-    : ALabel(config, "disk", id, "{}%", 30), path_("/") {
+    : AGraph(config, "disk", id, "{}%", 100, 30), path_("/") {
   thread_ = [this] {
     dp.emit();
     thread_.sleep_for(interval_);
@@ -57,6 +57,7 @@ auto waybar::modules::Disk::update() -> void {
   auto used = pow_format((stats.f_blocks - stats.f_bfree) * stats.f_frsize, "B", true);
   auto total = pow_format(stats.f_blocks * stats.f_frsize, "B", true);
   auto percentage_used = (stats.f_blocks - stats.f_bfree) * 100 / stats.f_blocks;
+  pushSample(percentage_used);
 
   auto format = format_;
   auto state = getState(percentage_used);
@@ -89,7 +90,7 @@ auto waybar::modules::Disk::update() -> void {
         fmt::arg("specific_used", specific_used), fmt::arg("specific_total", specific_total)));
   }
   // Call parent update
-  ALabel::update();
+  AGraph::update();
 }
 
 float waybar::modules::Disk::calc_specific_divisor(const std::string& divisor) {
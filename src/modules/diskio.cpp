@@ -0,0 +1,217 @@
+#include "modules/diskio.hpp"
+
+#include <fnmatch.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+#include "util/format.hpp"
+
+// In the 80000 version of fmt library authors decided to optimize imports
+// and moved declarations required for fmt::dynamic_format_arg_store in new
+// header fmt/args.h
+#if (FMT_VERSION >= 80000)
+#include <fmt/args.h>
+#else
+#include <fmt/core.h>
+#endif
+
+namespace waybar::modules {
+
+namespace {
+
+// Counters are unsigned long, so they wrap on 32-bit kernels
+uint64_t delta(uint64_t current, uint64_t previous) {
+  return current >= previous ? current - previous : 0;
+}
+
+constexpr double SECTOR_SIZE = 512;
+
+}  // namespace
+
+Diskio::Diskio(const std::string& id, const Json::Value& config)
+    : ALabel(config, "diskio", id, "{utilization}%", 10),
+      file_("/proc/diskstats"),
+      partitions_(config_["partitions"].isBool() && config_["partitions"].asBool()) {
+  if (!file_.isOpen()) {
+    throw std::runtime_error("Can't open /proc/diskstats");
+  }
+
+  if (config_["devices"].isString()) {
+    globs_.push_back(config_["devices"].asString());
+  } else if (config_["devices"].isArray()) {
+    for (const auto& glob : config_["devices"]) {
+      if (glob.isString()) {
+        globs_.push_back(glob.asString());
+      }
+    }
+  }
+  for (const auto& glob : globs_) {
+    auto prefix = glob.substr(0, glob.find_first_of("*?[\\"));
+    if (prefix.empty()) {
+      // A glob that can match any name disables the shortcut
+      prefixes_.clear();
+      break;
+    }
+    prefixes_.push_back(prefix);
+  }
+
+  sample();
+  thread_ = [this] {
+    dp.emit();
+    thread_.sleep_for(interval_);
+  };
+}
+
+bool Diskio::accept(std::string_view name) {
+  if (!prefixes_.empty() && std::none_of(prefixes_.begin(), prefixes_.end(),
+                                         [name](const auto& p) { return name.starts_with(p); })) {
+    return false;
+  }
+  auto it = accepted_.find(name);
+  if (it == accepted_.end()) {
+    std::string device(name);
+    it = accepted_.emplace(device, matches(device)).first;
+  }
+  return it->second;
+}
+
+bool Diskio::matches(const std::string& name) const {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  if (globs_.empty()) {
+    // Whole disks backed by hardware; loop, ram, zram, dm and md devices have no device link
+    return fs::exists(fs::path("/sys/block") / name / "device", ec);
+  }
+  if (std::none_of(globs_.begin(), globs_.end(), [&name](const auto& glob) {
+        return fnmatch(glob.c_str(), name.c_str(), 0) == 0;
+      })) {
+    return false;
+  }
+  return partitions_ || !fs::exists(fs::path("/sys/class/block") / name / "partition", ec);
+}
+
+void Diskio::sample() {
+  if (!file_.read(contents_)) {
+    spdlog::error("diskio: can't read /proc/diskstats");
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(now - sampled_at_).count();
+  sampled_at_ = now;
+  generation_++;
+
+  util::scanDiskstats(
+      contents_, [this](std::string_view name) { return accept(name); },
+      [&](const util::DiskStats& counters) {
+        auto it = devices_.find(counters.name);
+        if (it == devices_.end()) {
+          it = devices_.emplace(std::string(counters.name), Device{}).first;
+          it->second.counters = counters;
+        } else if (elapsed > 0) {
+          auto& device = it->second;
+          const auto& previous = device.counters;
+          device.read_bytes =
+              delta(counters.read_sectors, previous.read_sectors) * SECTOR_SIZE / elapsed;
+          device.write_bytes =
+              delta(counters.write_sectors, previous.write_sectors) * SECTOR_SIZE / elapsed;
+          device.read_iops = delta(counters.reads, previous.reads) / elapsed;
+          device.write_iops = delta(counters.writes, previous.writes) / elapsed;
+          device.utilization = std::min(
+              100.0, delta(counters.io_ticks, previous.io_ticks) / (elapsed * 1000) * 100);
+          device.counters = counters;
+        }
+        it->second.generation = generation_;
+      });
+
+  // Forget removed devices
+  std::erase_if(devices_, [this](const auto& entry) {
+    return entry.second.generation != generation_;
+  });
+  // The names point into contents_, which the next read overwrites
+  for (auto& [name, device] : devices_) {
+    device.counters.name = name;
+  }
+}
+
+auto Diskio::update() -> void {
+  sample();
+
+  double read_bytes = 0;
+  double write_bytes = 0;
+  double read_iops = 0;
+  double write_iops = 0;
+  // The busiest device; the average of saturated and idle disks would hide the saturation
+  double utilization = 0;
+  for (const auto& [name, device] : devices_) {
+    read_bytes += device.read_bytes;
+    write_bytes += device.write_bytes;
+    read_iops += device.read_iops;
+    write_iops += device.write_iops;
+    utilization = std::max(utilization, device.utilization);
+  }
+
+  auto percentage = std::lround(utilization);
+  auto format = format_;
+  auto state = getState(percentage);
+  if (!state.empty() && config_["format-" + state].isString()) {
+    format = config_["format-" + state].asString();
+  }
+
+  auto pushArgs = [](auto& store, double read_bytes, double write_bytes, double read_iops,
+                     double write_iops, double utilization) {
+    store.push_back(fmt::arg("read", pow_format(std::llround(read_bytes), "B/s", true)));
+    store.push_back(fmt::arg("write", pow_format(std::llround(write_bytes), "B/s", true)));
+    store.push_back(
+        fmt::arg("total", pow_format(std::llround(read_bytes + write_bytes), "B/s", true)));
+    store.push_back(fmt::arg("read_bytes", read_bytes));
+    store.push_back(fmt::arg("write_bytes", write_bytes));
+    store.push_back(fmt::arg("read_iops", read_iops));
+    store.push_back(fmt::arg("write_iops", write_iops));
+    store.push_back(fmt::arg("iops", read_iops + write_iops));
+    store.push_back(fmt::arg("utilization", std::lround(utilization)));
+  };
+
+  fmt::dynamic_format_arg_store<fmt::format_context> store;
+  pushArgs(store, read_bytes, write_bytes, read_iops, write_iops, utilization);
+  store.push_back(fmt::arg("devices", devices_.size()));
+  store.push_back(fmt::arg("icon", getIcon(percentage, std::vector<std::string>{state})));
+
+  if (format.empty()) {
+    event_box_.hide();
+  } else {
+    event_box_.show();
+    label_.set_markup(fmt::vformat(format, store));
+  }
+
+  if (tooltipEnabled()) {
+    if (config_["tooltip-format"].isString()) {
+      label_.set_tooltip_markup(fmt::vformat(config_["tooltip-format"].asString(), store));
+    } else {
+      // One line per device
+      std::string device_format = "{device}: {read} read, {write} written, {utilization}% busy";
+      if (config_["tooltip-format-device"].isString()) {
+        device_format = config_["tooltip-format-device"].asString();
+      }
+      std::string tooltip;
+      for (const auto& [name, device] : devices_) {
+        fmt::dynamic_format_arg_store<fmt::format_context> device_store;
+        pushArgs(device_store, device.read_bytes, device.write_bytes, device.read_iops,
+                 device.write_iops, device.utilization);
+        device_store.push_back(fmt::arg("device", name));
+        if (!tooltip.empty()) {
+          tooltip += '\n';
+        }
+        tooltip += fmt::vformat(device_format, device_store);
+      }
+      label_.set_tooltip_markup(tooltip);
+    }
+  }
+
+  // Call parent update
+  ALabel::update();
+}
+
+}  // namespace waybar::modules
@@ -68,54 +68,15 @@ static const zdwl_ipc_output_v2_listener output_status_listener_impl{
     .frame = dwl_frame,
 };
 
-static void handle_global(void* data, struct wl_registry* registry, uint32_t name,
-                          const char* interface, uint32_t version) {
-  
-if (std::strcmp(interface, zdwl_ipc_manager_v2_interface.name) == 0) {
-  auto* self = static_cast<Tags*>(data);
-
-  if (self->status_manager_) {
-  zdwl_ipc_manager_v2_destroy(self->status_manager_);
-  self->status_manager_ = nullptr;
-}
-
-  self->status_manager_ = static_cast<struct zdwl_ipc_manager_v2*>(
-      wl_registry_bind(registry, name, &zdwl_ipc_manager_v2_interface, 1));
-}
-
-if (std::strcmp(interface, wl_seat_interface.name) == 0) {
-  auto* self = static_cast<Tags*>(data);
-
-  if (self->seat_) {
-    wl_seat_destroy(self->seat_);
-    self->seat_ = nullptr;
-  }
-
-  version = std::min<uint32_t>(version, 1);
-
-  self->seat_ = static_cast<struct wl_seat*>(
-      wl_registry_bind(registry, name, &wl_seat_interface, version));
-}
-}
-static void handle_global_remove(void* data, struct wl_registry* registry, uint32_t name) {
-  /* Ignore event */
-}
-
-static const wl_registry_listener registry_listener_impl = {.global = handle_global,
-                                                            .global_remove = handle_global_remove};
-
 Tags::Tags(const std::string& id, const waybar::Bar& bar, const Json::Value& config)
     : waybar::AModule(config, "tags", id, false, false),
-      status_manager_{nullptr},
-      seat_{nullptr},
       bar_(bar),
       box_{bar.orientation, 0},
       output_status_{nullptr} {
-  struct wl_display* display = Client::inst()->wl_display;
-  struct wl_registry* registry = wl_display_get_registry(display);
-
-  wl_registry_add_listener(registry, &registry_listener_impl, this);
-  wl_display_roundtrip(display);
+  auto& globals = Client::inst()->globals;
+  status_manager_ =
+      globals.acquire(zdwl_ipc_manager_v2_interface, 1, &zdwl_ipc_manager_v2_destroy);
+  seat_ = globals.acquire(wl_seat_interface, 1, &wl_seat_destroy);
 
   if (!status_manager_) {
     spdlog::error("dwl_status_manager_v2 not advertised");
@@ -164,20 +125,14 @@ Tags::Tags(const std::string& id, const waybar::Bar& bar, const Json::Value& con
   }
 
   struct wl_output* output = gdk_wayland_monitor_get_wl_output(bar_.output->monitor->gobj());
-  output_status_ = zdwl_ipc_manager_v2_get_output(status_manager_, output);
+  output_status_ = zdwl_ipc_manager_v2_get_output(status_manager_.get(), output);
   zdwl_ipc_output_v2_add_listener(output_status_, &output_status_listener_impl, this);
-
-  zdwl_ipc_manager_v2_destroy(status_manager_);
-  status_manager_ = nullptr;
 }
 
 Tags::~Tags() {
   if (output_status_) {
     zdwl_ipc_output_v2_destroy(output_status_);
   }
-  if (status_manager_) {
-    zdwl_ipc_manager_v2_destroy(status_manager_);
-  }
 }
 
 void Tags::handle_primary_clicked(uint32_t tag) {
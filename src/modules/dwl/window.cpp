@@ -58,28 +58,10 @@ static const zdwl_ipc_output_v2_listener output_status_listener_impl{
     .frame = dwl_frame,
 };
 
-static void handle_global(void* data, struct wl_registry* registry, uint32_t name,
-                          const char* interface, uint32_t version) {
-  if (std::strcmp(interface, zdwl_ipc_manager_v2_interface.name) == 0) {
-    static_cast<Window*>(data)->status_manager_ = static_cast<struct zdwl_ipc_manager_v2*>(
-        (zdwl_ipc_manager_v2*)wl_registry_bind(registry, name, &zdwl_ipc_manager_v2_interface, 1));
-  }
-}
-
-static void handle_global_remove(void* data, struct wl_registry* registry, uint32_t name) {
-  /* Ignore event */
-}
-
-static const wl_registry_listener registry_listener_impl = {.global = handle_global,
-                                                            .global_remove = handle_global_remove};
-
 Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
     : AAppIconLabel(config, "window", id, "{}", 0, true), bar_(bar) {
-  struct wl_display* display = Client::inst()->wl_display;
-  struct wl_registry* registry = wl_display_get_registry(display);
-
-  wl_registry_add_listener(registry, &registry_listener_impl, this);
-  wl_display_roundtrip(display);
+  status_manager_ = Client::inst()->globals.acquire(zdwl_ipc_manager_v2_interface, 1,
+                                                    &zdwl_ipc_manager_v2_destroy);
 
   if (status_manager_ == nullptr) {
     spdlog::error("dwl_status_manager_v2 not advertised");
@@ -87,9 +69,8 @@ Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
   }
 
   struct wl_output* output = gdk_wayland_monitor_get_wl_output(bar_.output->monitor->gobj());
-  output_status_ = zdwl_ipc_manager_v2_get_output(status_manager_, output);
+  output_status_ = zdwl_ipc_manager_v2_get_output(status_manager_.get(), output);
   zdwl_ipc_output_v2_add_listener(output_status_, &output_status_listener_impl, this);
-  zdwl_ipc_manager_v2_destroy(status_manager_);
 }
 
 Window::~Window() {
@@ -23,7 +23,7 @@ std::map<std::string, std::string> Workspace::icon_map_;
 WorkspaceManager::WorkspaceManager(const std::string& id, const waybar::Bar& bar,
                                    const Json::Value& config)
     : waybar::AModule(config, "workspaces", id, false, false), bar_(bar), box_(bar.orientation, 0) {
-  add_registry_listener(this);
+  register_manager();
 
   // parse configuration
 
@@ -84,9 +84,9 @@ WorkspaceManager::~WorkspaceManager() {
   spdlog::debug("[ext/workspaces]: Workspace manager destroyed");
 }
 
-void WorkspaceManager::register_manager(wl_registry* registry, uint32_t name, uint32_t version) {
-  if (ext_manager_ != nullptr) {
-    spdlog::warn("[ext/workspaces]: Register workspace manager again although already registered!");
+void WorkspaceManager::register_manager() {
+  auto version = Client::inst()->globals.version(ext_workspace_manager_v1_interface);
+  if (version == 0) {
     return;
   }
   if (version != 1) {
@@ -94,7 +94,7 @@ void WorkspaceManager::register_manager(wl_registry* registry, uint32_t name, ui
                  version);
   }
 
-  ext_manager_ = workspace_manager_bind(registry, name, version, this);
+  ext_manager_ = workspace_manager_bind(this);
 }
 
 void WorkspaceManager::remove_workspace_group(uint32_t id) {
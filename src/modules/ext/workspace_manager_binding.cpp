@@ -9,28 +9,6 @@
 
 namespace waybar::modules::ext {
 
-static void handle_global(void* data, wl_registry* registry, uint32_t name, const char* interface,
-                          uint32_t version) {
-  if (std::strcmp(interface, ext_workspace_manager_v1_interface.name) == 0) {
-    static_cast<WorkspaceManager*>(data)->register_manager(registry, name, version);
-  }
-}
-
-static void handle_global_remove(void* data, wl_registry* registry, uint32_t name) {
-  /* Nothing to do here */
-}
-
-static const wl_registry_listener registry_listener_impl = {.global = handle_global,
-                                                            .global_remove = handle_global_remove};
-
-void add_registry_listener(void* data) {
-  wl_display* display = Client::inst()->wl_display;
-  wl_registry* registry = wl_display_get_registry(display);
-
-  wl_registry_add_listener(registry, &registry_listener_impl, data);
-  wl_display_roundtrip(display);
-}
-
 static void workspace_manager_handle_workspace_group(
     void* data, ext_workspace_manager_v1* _, ext_workspace_group_handle_v1* workspace_group) {
   static_cast<WorkspaceManager*>(data)->handle_workspace_group(workspace_group);
@@ -56,10 +34,10 @@ static const ext_workspace_manager_v1_listener workspace_manager_impl = {
     .finished = workspace_manager_handle_finished,
 };
 
-ext_workspace_manager_v1* workspace_manager_bind(wl_registry* registry, uint32_t name,
-                                                 uint32_t version, void* data) {
-  auto* workspace_manager = static_cast<ext_workspace_manager_v1*>(
-      wl_registry_bind(registry, name, &ext_workspace_manager_v1_interface, version));
+ext_workspace_manager_v1* workspace_manager_bind(void* data) {
+  // Every module listens to a manager of its own
+  auto* workspace_manager =
+      Client::inst()->globals.bind<ext_workspace_manager_v1>(ext_workspace_manager_v1_interface);
 
   if (workspace_manager)
     ext_workspace_manager_v1_add_listener(workspace_manager, &workspace_manager_impl, data);
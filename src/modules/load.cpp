@@ -10,7 +10,7 @@
 #endif
 
 waybar::modules::Load::Load(const std::string& id, const Json::Value& config)
-    : ALabel(config, "load", id, "{load1}", 10) {
+    : AGraph(config, "load", id, "{load1}", 0, 10) {
   thread_ = [this] {
     dp.emit();
     thread_.sleep_for(interval_);
@@ -20,6 +20,7 @@ waybar::modules::Load::Load(const std::string& id, const Json::Value& config)
 auto waybar::modules::Load::update() -> void {
   // TODO: as creating dynamic fmt::arg arrays is buggy we have to calc both
   auto [load1, load5, load15] = Load::getLoad();
+  pushSample(load1);
   if (tooltipEnabled()) {
     auto tooltip = fmt::format("Load 1: {}\nLoad 5: {}\nLoad 15: {}", load1, load5, load15);
     label_.set_tooltip_markup(tooltip);
@@ -46,7 +47,7 @@ auto waybar::modules::Load::update() -> void {
   }
 
   // Call parent update
-  ALabel::update();
+  AGraph::update();
 }
 
 std::tuple<double, double, double> waybar::modules::Load::getLoad() {
@@ -1,7 +1,7 @@
 #include "modules/memory.hpp"
 
 waybar::modules::Memory::Memory(const std::string& id, const Json::Value& config)
-    : ALabel(config, "memory", id, "{}%", 30) {
+    : AGraph(config, "memory", id, "{}%", 100, 30) {
   thread_ = [this] {
     dp.emit();
     thread_.sleep_for(interval_);
@@ -48,6 +48,7 @@ auto waybar::modules::Memory::update() -> void {
     float available_ram = memfree / divisor;
     float available_swap = swapfree / divisor;
 
+    pushSample(used_ram_percentage);
     auto format = format_;
     auto state = getState(used_ram_percentage);
     if (!state.empty() && config_["format-" + state].isString()) {
@@ -89,7 +90,7 @@ auto waybar::modules::Memory::update() -> void {
     event_box_.hide();
   }
   // Call parent update
-  ALabel::update();
+  AGraph::update();
 }
 
 float waybar::modules::Memory::calc_divisor(const std::string& divisor) {
@@ -2,6 +2,8 @@
 
 #include <fmt/core.h>
 
+#include <algorithm>
+#include <cmath>
 #include <optional>
 #include <sstream>
 #include <string>
@@ -18,6 +20,18 @@ namespace waybar::modules::mpris {
 
 const std::string DEFAULT_FORMAT = "{player} ({status}): {dynamic}";
 
+namespace {
+
+auto formatDuration(int64_t us) -> std::string {
+  auto len = std::chrono::microseconds(us);
+  auto len_h = std::chrono::duration_cast<std::chrono::hours>(len);
+  auto len_m = std::chrono::duration_cast<std::chrono::minutes>(len - len_h);
+  auto len_s = std::chrono::duration_cast<std::chrono::seconds>(len - len_h - len_m);
+  return fmt::format("{:02}:{:02}:{:02}", len_h.count(), len_m.count(), len_s.count());
+}
+
+}  // namespace
+
 Mpris::Mpris(const std::string& id, const Json::Value& config)
     : ALabel(config, "mpris", id, DEFAULT_FORMAT, 0, false, true),
       tooltip_(DEFAULT_FORMAT),
@@ -34,8 +48,7 @@ Mpris::Mpris(const std::string& id, const Json::Value& config)
       ellipsis_("\u2026"),
       player_("playerctld"),
       manager(),
-      player(),
-      last_update_(std::chrono::system_clock::now() - interval_) {
+      player() {
   if (config_["format-playing"].isString()) {
     format_playing_ = config_["format-playing"].asString();
   }
@@ -160,17 +173,18 @@ Mpris::Mpris(const std::string& id, const Json::Value& config)
   }
 
   if (player) {
-    g_object_connect(player, "signal::play", G_CALLBACK(onPlayerPlay), this, "signal::pause",
-                     G_CALLBACK(onPlayerPause), this, "signal::stop", G_CALLBACK(onPlayerStop),
-                     this, "signal::metadata", G_CALLBACK(onPlayerMetadata), this, NULL);
+    connectPlayer(player);
   }
 
-  // allow setting an interval count that triggers periodic refreshes
+  // The position is extrapolated locally, so this is only a safety net for players that do not
+  // announce their changes
   if (interval_.count() > 0) {
-    thread_ = [this] {
-      dp.emit();
-      thread_.sleep_for(interval_);
-    };
+    resync_timer_ = Glib::signal_timeout().connect_seconds(
+        [this] {
+          resync();
+          return true;
+        },
+        std::chrono::duration_cast<std::chrono::seconds>(interval_).count());
   }
 
   // trigger initial update
@@ -178,6 +192,9 @@ Mpris::Mpris(const std::string& id, const Json::Value& config)
 }
 
 Mpris::~Mpris() {
+  position_timer_.disconnect();
+  resync_timer_.disconnect();
+  unwatchPlaybackRate();
   if (manager != nullptr) {
     g_signal_handlers_disconnect_by_data(manager, this);
   }
@@ -191,6 +208,19 @@ Mpris::~Mpris() {
   g_clear_object(&player);
 }
 
+auto Mpris::connectPlayer(PlayerctlPlayer* p) -> void {
+  g_object_connect(p, "signal::play", G_CALLBACK(onPlayerPlay), this, "signal::pause",
+                   G_CALLBACK(onPlayerPause), this, "signal::stop", G_CALLBACK(onPlayerStop), this,
+                   "signal::metadata", G_CALLBACK(onPlayerMetadata), this, "signal::seeked",
+                   G_CALLBACK(onPlayerSeeked), this, NULL);
+}
+
+// Drop the cached player state so that the next update queries the player again
+auto Mpris::resync() -> void {
+  info_dirty_ = true;
+  dp.emit();
+}
+
 auto Mpris::getIconFromJson(const Json::Value& icons, const std::string& key) -> std::string {
   if (icons.isObject()) {
     if (icons[key].isString()) return icons[key].asString();
@@ -424,11 +454,9 @@ auto Mpris::onPlayerNameAppeared(PlayerctlPlayerManager* manager, PlayerctlPlaye
     g_clear_object(&mpris->player);
   }
   mpris->player = playerctl_player_new_from_name(player_name, nullptr);
-  g_object_connect(mpris->player, "signal::play", G_CALLBACK(onPlayerPlay), mpris, "signal::pause",
-                   G_CALLBACK(onPlayerPause), mpris, "signal::stop", G_CALLBACK(onPlayerStop),
-                   mpris, "signal::metadata", G_CALLBACK(onPlayerMetadata), mpris, NULL);
+  mpris->connectPlayer(mpris->player);
 
-  mpris->dp.emit();
+  mpris->resync();
 }
 
 auto Mpris::onPlayerNameVanished(PlayerctlPlayerManager* manager, PlayerctlPlayerName* player_name,
@@ -439,11 +467,11 @@ auto Mpris::onPlayerNameVanished(PlayerctlPlayerManager* manager, PlayerctlPlaye
   spdlog::debug("mpris: name-vanished callback: {}", player_name->name);
 
   if (mpris->player_ == "playerctld") {
-    mpris->dp.emit();
+    mpris->resync();
   } else if (mpris->player_ == player_name->name) {
     mpris->player = nullptr;
     mpris->event_box_.set_visible(false);
-    mpris->dp.emit();
+    mpris->resync();
   }
 }
 
@@ -453,7 +481,7 @@ auto Mpris::onPlayerPlay(PlayerctlPlayer* player, gpointer data) -> void {
 
   spdlog::debug("mpris: player-play callback");
   // update widget
-  mpris->dp.emit();
+  mpris->resync();
 }
 
 auto Mpris::onPlayerPause(PlayerctlPlayer* player, gpointer data) -> void {
@@ -462,7 +490,7 @@ auto Mpris::onPlayerPause(PlayerctlPlayer* player, gpointer data) -> void {
 
   spdlog::debug("mpris: player-pause callback");
   // update widget
-  mpris->dp.emit();
+  mpris->resync();
 }
 
 auto Mpris::onPlayerStop(PlayerctlPlayer* player, gpointer data) -> void {
@@ -471,7 +499,7 @@ auto Mpris::onPlayerStop(PlayerctlPlayer* player, gpointer data) -> void {
 
   spdlog::debug("mpris: player-stop callback");
   // update widget (update() handles visibility)
-  mpris->dp.emit();
+  mpris->resync();
 }
 
 auto Mpris::onPlayerMetadata(PlayerctlPlayer* player, GVariant* metadata, gpointer data) -> void {
@@ -480,9 +508,161 @@ auto Mpris::onPlayerMetadata(PlayerctlPlayer* player, GVariant* metadata, gpoint
 
   spdlog::debug("mpris: player-metadata callback");
   // update widget
+  mpris->resync();
+}
+
+auto Mpris::onPlayerSeeked(PlayerctlPlayer* player, gint64 position, gpointer data) -> void {
+  auto* mpris = static_cast<Mpris*>(data);
+  if (!mpris) return;
+
+  spdlog::debug("mpris: player-seeked callback: {}", position);
+  // Seeking does not change anything but the position, which the signal carries
+  if (mpris->info_dirty_ || !mpris->info_) {
+    mpris->resync();
+    return;
+  }
+  mpris->info_->position_us = position;
+  mpris->position_synced_at_ = std::chrono::steady_clock::now();
   mpris->dp.emit();
 }
 
+// MPRIS Rate is not exposed by playerctl. It is read asynchronously once per player, then kept
+// up to date from the player's PropertiesChanged signals.
+auto Mpris::watchPlaybackRate(PlayerctlPlayer* p) -> void {
+  gchar* instance = nullptr;
+  PlayerctlSource source = PLAYERCTL_SOURCE_DBUS_SESSION;
+  g_object_get(p, "player-instance", &instance, "source", &source, NULL);
+  if (instance == nullptr) {
+    return;
+  }
+  auto bus_name = fmt::format("org.mpris.MediaPlayer2.{}", instance);
+  g_free(instance);
+  if (bus_name == rate_bus_name_) {
+    return;
+  }
+
+  unwatchPlaybackRate();
+  rate_bus_name_ = bus_name;
+  rate_cancellable_ = g_cancellable_new();
+  g_bus_get(source == PLAYERCTL_SOURCE_DBUS_SYSTEM ? G_BUS_TYPE_SYSTEM : G_BUS_TYPE_SESSION,
+            rate_cancellable_, onRateBus, this);
+}
+
+auto Mpris::unwatchPlaybackRate() -> void {
+  if (rate_cancellable_ != nullptr) {
+    g_cancellable_cancel(rate_cancellable_);
+    g_clear_object(&rate_cancellable_);
+  }
+  if (rate_subscription_ != 0) {
+    g_dbus_connection_signal_unsubscribe(rate_connection_, rate_subscription_);
+    rate_subscription_ = 0;
+  }
+  g_clear_object(&rate_connection_);
+  rate_bus_name_.clear();
+  // Rate is optional, players without it play at normal speed
+  rate_ = 1.0;
+}
+
+auto Mpris::onRateBus(GObject* source, GAsyncResult* res, gpointer data) -> void {
+  GError* error = nullptr;
+  auto* connection = g_bus_get_finish(res, &error);
+  if (connection == nullptr) {
+    // Also the case when the watch was dropped, the module may be gone already
+    g_clear_error(&error);
+    return;
+  }
+  auto* mpris = static_cast<Mpris*>(data);
+  mpris->rate_connection_ = connection;
+  mpris->rate_subscription_ = g_dbus_connection_signal_subscribe(
+      connection, mpris->rate_bus_name_.c_str(), "org.freedesktop.DBus.Properties",
+      "PropertiesChanged", "/org/mpris/MediaPlayer2", "org.mpris.MediaPlayer2.Player",
+      G_DBUS_SIGNAL_FLAGS_NONE, onRatePropertiesChanged, mpris, nullptr);
+  g_dbus_connection_call(connection, mpris->rate_bus_name_.c_str(), "/org/mpris/MediaPlayer2",
+                         "org.freedesktop.DBus.Properties", "Get",
+                         g_variant_new("(ss)", "org.mpris.MediaPlayer2.Player", "Rate"),
+                         G_VARIANT_TYPE("(v)"), G_DBUS_CALL_FLAGS_NONE, -1,
+                         mpris->rate_cancellable_, onRateReply, mpris);
+}
+
+auto Mpris::onRateReply(GObject* source, GAsyncResult* res, gpointer data) -> void {
+  GError* error = nullptr;
+  auto* reply = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source), res, &error);
+  if (reply == nullptr) {
+    g_clear_error(&error);
+    return;
+  }
+  GVariant* value = nullptr;
+  g_variant_get(reply, "(v)", &value);
+  if (g_variant_is_of_type(value, G_VARIANT_TYPE_DOUBLE)) {
+    static_cast<Mpris*>(data)->setPlaybackRate(g_variant_get_double(value));
+  }
+  g_variant_unref(value);
+  g_variant_unref(reply);
+}
+
+auto Mpris::onRatePropertiesChanged(GDBusConnection* connection, const gchar* sender_name,
+                                    const gchar* object_path, const gchar* interface_name,
+                                    const gchar* signal_name, GVariant* parameters,
+                                    gpointer data) -> void {
+  if (!g_variant_is_of_type(parameters, G_VARIANT_TYPE("(sa{sv}as)"))) {
+    return;
+  }
+  GVariant* changed = g_variant_get_child_value(parameters, 1);
+  if (auto* rate = g_variant_lookup_value(changed, "Rate", G_VARIANT_TYPE_DOUBLE)) {
+    static_cast<Mpris*>(data)->setPlaybackRate(g_variant_get_double(rate));
+    g_variant_unref(rate);
+  }
+  g_variant_unref(changed);
+}
+
+auto Mpris::setPlaybackRate(double rate) -> void {
+  if (rate == rate_) {
+    return;
+  }
+  spdlog::debug("mpris: playback rate = {}", rate);
+  rate_ = rate;
+  // The extrapolated position depends on the rate
+  resync();
+}
+
+auto Mpris::currentPosition(const PlayerInfo& info) const -> std::optional<int64_t> {
+  if (!info.position_us) {
+    return std::nullopt;
+  }
+  auto position = *info.position_us;
+  if (info.status == PLAYERCTL_PLAYBACK_STATUS_PLAYING) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - position_synced_at_);
+    position += std::llround(elapsed.count() * info.rate);
+  }
+  position = std::max<int64_t>(position, 0);
+  if (info.length_us && *info.length_us > 0) {
+    position = std::min(position, *info.length_us);
+  }
+  return position;
+}
+
+// Re-render when the extrapolated position reaches the next whole second. Paused and stopped
+// players do not move, so they get no timer at all.
+auto Mpris::schedulePositionUpdate() -> void {
+  position_timer_.disconnect();
+  if (!info_ || info_->status != PLAYERCTL_PLAYBACK_STATUS_PLAYING || info_->rate <= 0) {
+    return;
+  }
+  auto position = currentPosition(*info_);
+  if (!position || (info_->length_us && *position >= *info_->length_us)) {
+    return;
+  }
+  auto until_next_second = 1000000 - *position % 1000000;
+  auto delay_ms = static_cast<unsigned int>(std::ceil(until_next_second / info_->rate / 1000)) + 1;
+  position_timer_ = Glib::signal_timeout().connect(
+      [this] {
+        dp.emit();
+        return false;
+      },
+      delay_ms);
+}
+
 auto Mpris::getPlayerInfo() -> std::optional<PlayerInfo> {
   if (!player) {
     return std::nullopt;
@@ -595,11 +775,8 @@ auto Mpris::getPlayerInfo() -> std::optional<PlayerInfo> {
   if (auto* length_ =
           playerctl_player_print_metadata_prop(last_active_player_, "mpris:length", &error)) {
     spdlog::debug("mpris[{}]: mpris:length = {}", info.name, length_);
-    auto len = std::chrono::microseconds(std::strtol(length_, nullptr, 10));
-    auto len_h = std::chrono::duration_cast<std::chrono::hours>(len);
-    auto len_m = std::chrono::duration_cast<std::chrono::minutes>(len - len_h);
-    auto len_s = std::chrono::duration_cast<std::chrono::seconds>(len - len_h - len_m);
-    info.length = fmt::format("{:02}:{:02}:{:02}", len_h.count(), len_m.count(), len_s.count());
+    info.length_us = std::strtol(length_, nullptr, 10);
+    info.length = formatDuration(*info.length_us);
     g_free(length_);
   }
   if (error) goto errorexit;
@@ -612,11 +789,11 @@ auto Mpris::getPlayerInfo() -> std::optional<PlayerInfo> {
       error = nullptr;
     } else {
       spdlog::debug("mpris[{}]: position = {}", info.name, position_);
-      auto len = std::chrono::microseconds(position_);
-      auto len_h = std::chrono::duration_cast<std::chrono::hours>(len);
-      auto len_m = std::chrono::duration_cast<std::chrono::minutes>(len - len_h);
-      auto len_s = std::chrono::duration_cast<std::chrono::seconds>(len - len_h - len_m);
-      info.position = fmt::format("{:02}:{:02}:{:02}", len_h.count(), len_m.count(), len_s.count());
+      info.position_us = position_;
+      if (info.status == PLAYERCTL_PLAYBACK_STATUS_PLAYING) {
+        watchPlaybackRate(last_active_player_);
+        info.rate = rate_;
+      }
     }
   }
 
@@ -685,17 +862,22 @@ bool Mpris::handleToggle(GdkEventButton* const& e) {
 }
 
 auto Mpris::update() -> void {
-  const auto now = std::chrono::system_clock::now();
-  if (now - last_update_ < interval_) return;
-  last_update_ = now;
+  position_timer_.disconnect();
+  if (info_dirty_) {
+    info_dirty_ = false;
+    info_ = getPlayerInfo();
+    position_synced_at_ = std::chrono::steady_clock::now();
+  }
 
-  auto opt = getPlayerInfo();
-  if (!opt) {
+  if (!info_) {
     event_box_.set_visible(false);
     ALabel::update();
     return;
   }
-  auto info = *opt;
+  auto info = *info_;
+  if (auto position = currentPosition(info)) {
+    info.position = formatDuration(*position);
+  }
 
   if (info.status == PLAYERCTL_PLAYBACK_STATUS_STOPPED) {
     spdlog::debug("mpris[{}]: player stopped, skipping update", info.name);
@@ -790,6 +972,7 @@ auto Mpris::update() -> void {
   }
 
   event_box_.set_visible(true);
+  schedulePositionUpdate();
   // call parent update
   ALabel::update();
 }
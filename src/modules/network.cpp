@@ -1,5 +1,6 @@
 #include "modules/network.hpp"
 
+#include <linux/filter.h>
 #include <linux/if.h>
 #include <linux/if_link.h>
 #include <netlink/netlink.h>
@@ -7,6 +8,7 @@
 #include <sys/eventfd.h>
 
 #include <cassert>
+#include <cstddef>
 #include <cstring>
 #include <fstream>
 #include <optional>
@@ -28,6 +30,59 @@ constexpr const char* NETDEV_FILE =
     "/proc/net/dev";  // std::ifstream does not take std::string_view as param
 std::optional<std::pair<unsigned long long, unsigned long long>>
 waybar::modules::Network::readBandwidthUsage() {
+  if (ifname_.empty()) {
+    return {{0ull, 0ull}};
+  }
+  // One binary message for our interface instead of parsing every interface of the host
+  if (auto stats = readLinkStats(); stats.has_value()) {
+    return stats;
+  }
+  return readNetDev();
+}
+
+std::optional<std::pair<unsigned long long, unsigned long long>>
+waybar::modules::Network::readLinkStats() {
+  if (stats_sock_ == nullptr || ifid_ <= 0) {
+    return {};
+  }
+
+  struct ifinfomsg ifinfo_hdr = {
+      .ifi_family = AF_UNSPEC,
+      .ifi_index = ifid_,
+  };
+  link_stats_.reset();
+  if (nl_send_simple(stats_sock_, RTM_GETLINK, NLM_F_REQUEST, &ifinfo_hdr, sizeof(ifinfo_hdr)) <
+      0) {
+    return {};
+  }
+  int rc = nl_recvmsgs_default(stats_sock_);
+  if (rc < 0) {
+    spdlog::debug("network: link stats request failed: {}", nl_geterror(-rc));
+    return {};
+  }
+  return link_stats_;
+}
+
+int waybar::modules::Network::handleLinkStats(struct nl_msg* msg, void* data) {
+  auto net = static_cast<waybar::modules::Network*>(data);
+  auto nh = nlmsg_hdr(msg);
+  if (nh->nlmsg_type != RTM_NEWLINK) {
+    return NL_SKIP;
+  }
+
+  struct nlattr* attrs[IFLA_MAX + 1];
+  if (nlmsg_parse(nh, sizeof(struct ifinfomsg), attrs, IFLA_MAX, nullptr) < 0 ||
+      attrs[IFLA_STATS64] == nullptr) {
+    return NL_SKIP;
+  }
+  rtnl_link_stats64 stats{};
+  nla_memcpy(&stats, attrs[IFLA_STATS64], sizeof(stats));
+  net->link_stats_ = {stats.rx_bytes, stats.tx_bytes};
+  return NL_OK;
+}
+
+std::optional<std::pair<unsigned long long, unsigned long long>>
+waybar::modules::Network::readNetDev() {
   std::ifstream netdev(NETDEV_FILE);
   if (!netdev) {
     spdlog::warn("Failed to open netdev file {}", NETDEV_FILE);
@@ -84,7 +139,7 @@ waybar::modules::Network::readBandwidthUsage() {
 }
 
 waybar::modules::Network::Network(const std::string& id, const Json::Value& config)
-    : ALabel(config, "network", id, DEFAULT_FORMAT, 60) {
+    : AGraph(config, "network", id, DEFAULT_FORMAT, 0, 60) {
   // Start with some "text" in the module's label_. update() will then
   // update it. Since the text should be different, update() will be able
   // to show or hide the event_box_. This is to work around the case where
@@ -120,6 +175,7 @@ waybar::modules::Network::Network(const std::string& id, const Json::Value& conf
 
   createEventSocket();
   createInfoSocket();
+  createStatsSocket();
 
   dp.emit();
   // Ask for a dump of interfaces and then addresses to populate our
@@ -145,6 +201,10 @@ waybar::modules::Network::~Network() {
     nl_close(sock_);
     nl_socket_free(sock_);
   }
+  if (stats_sock_ != nullptr) {
+    nl_close(stats_sock_);
+    nl_socket_free(stats_sock_);
+  }
 }
 
 void waybar::modules::Network::createEventSocket() {
@@ -164,6 +224,7 @@ void waybar::modules::Network::createEventSocket() {
   if (!config_["interface"].isString()) {
     nl_socket_add_memberships(ev_sock_, RTNLGRP_IPV4_ROUTE, RTNLGRP_IPV6_ROUTE, 0);
   }
+  updateEventFilter();
 
   efd_ = epoll_create1(EPOLL_CLOEXEC);
   if (efd_ < 0) {
@@ -191,6 +252,77 @@ void waybar::modules::Network::createEventSocket() {
   }
 }
 
+/* Drops events the module would ignore before they reach userspace: link and address changes of
+ * other interfaces once one is selected, and routes that can't be a default route of the main
+ * table. On hosts with container veth churn that is nearly all of them. Replies to our own
+ * requests (dumps, RTM_GETLINK) always pass.
+ */
+void waybar::modules::Network::updateEventFilter() {
+  if (filter_attached_ && filter_ifid_ == ifid_) {
+    return;
+  }
+
+  // Index fields of ifinfomsg and ifaddrmsg share one offset
+  static_assert(offsetof(struct ifinfomsg, ifi_index) == offsetof(struct ifaddrmsg, ifa_index));
+  constexpr uint32_t INDEX_OFFSET = NLMSG_HDRLEN + offsetof(struct ifinfomsg, ifi_index);
+  constexpr uint8_t ROUTE = 9;
+  constexpr uint8_t INTERFACE = 13;
+  constexpr uint8_t ACCEPT = 15;
+  constexpr uint8_t DROP = 16;
+  // Until an interface is selected all link and address events are needed
+  const uint8_t by_index = ifid_ > 0 ? INTERFACE : ACCEPT;
+  auto to = [](uint8_t target, uint8_t from) { return static_cast<uint8_t>(target - from - 1); };
+
+  // Absolute loads are big endian, hence htons/htonl on the host order netlink fields
+  struct sock_filter code[] = {
+      /* 0 */ BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct nlmsghdr, nlmsg_pid)),
+      /* 1 */
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(nl_socket_get_local_port(ev_sock_)), to(ACCEPT, 1),
+               0),
+      /* 2 */ BPF_STMT(BPF_LD | BPF_H | BPF_ABS, offsetof(struct nlmsghdr, nlmsg_type)),
+      /* 3 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWROUTE), to(ROUTE, 3), 0),
+      /* 4 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELROUTE), to(ROUTE, 4), 0),
+      /* 5 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWLINK), to(by_index, 5), 0),
+      /* 6 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELLINK), to(by_index, 6), 0),
+      /* 7 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWADDR), to(by_index, 7), 0),
+      /* 8 */
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELADDR), to(by_index, 8), to(ACCEPT, 8)),
+      /* 9: ROUTE */
+      BPF_STMT(BPF_LD | BPF_B | BPF_ABS, NLMSG_HDRLEN + offsetof(struct rtmsg, rtm_table)),
+      /* 10 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, RT_TABLE_MAIN, 0, to(DROP, 10)),
+      /* 11 */
+      BPF_STMT(BPF_LD | BPF_B | BPF_ABS, NLMSG_HDRLEN + offsetof(struct rtmsg, rtm_dst_len)),
+      /* 12 */ BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, to(ACCEPT, 12), to(DROP, 12)),
+      /* 13: INTERFACE */ BPF_STMT(BPF_LD | BPF_W | BPF_ABS, INDEX_OFFSET),
+      /* 14 */
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(static_cast<uint32_t>(ifid_)), to(ACCEPT, 14),
+               to(DROP, 14)),
+      /* 15: ACCEPT */ BPF_STMT(BPF_RET | BPF_K, 0xffffffff),
+      /* 16: DROP */ BPF_STMT(BPF_RET | BPF_K, 0),
+  };
+  struct sock_fprog prog = {
+      .len = sizeof(code) / sizeof(code[0]),
+      .filter = code,
+  };
+  if (setsockopt(nl_socket_get_fd(ev_sock_), SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) <
+      0) {
+    spdlog::debug("network: can't attach event filter: {}", strerror(errno));
+    filter_attached_ = false;
+    return;
+  }
+
+  // Events of other interfaces that raced with a filter for the previous one are gone, so ask
+  // for the current state once the module is looking for an interface again
+  if (filter_attached_ && filter_ifid_ > 0 && ifid_ <= 0 && config_["interface"].isString()) {
+    want_link_dump_ = true;
+    want_addr_dump_ = true;
+    askForStateDump();
+  }
+  spdlog::debug("network: event filter for if{}", ifid_);
+  filter_attached_ = true;
+  filter_ifid_ = ifid_;
+}
+
 void waybar::modules::Network::createInfoSocket() {
   sock_ = nl_socket_alloc();
   if (genl_connect(sock_) != 0) {
@@ -205,6 +337,18 @@ void waybar::modules::Network::createInfoSocket() {
   }
 }
 
+void waybar::modules::Network::createStatsSocket() {
+  stats_sock_ = nl_socket_alloc();
+  // The reply is a single RTM_NEWLINK, don't leave an ACK behind in the socket
+  nl_socket_disable_auto_ack(stats_sock_);
+  if (nl_connect(stats_sock_, NETLINK_ROUTE) != 0 ||
+      nl_socket_modify_cb(stats_sock_, NL_CB_VALID, NL_CB_CUSTOM, handleLinkStats, this) < 0) {
+    spdlog::warn("network: can't query link stats over netlink, falling back to {}", NETDEV_FILE);
+    nl_socket_free(stats_sock_);
+    stats_sock_ = nullptr;
+  }
+}
+
 void waybar::modules::Network::worker() {
   // update via here not working
   thread_timer_ = [this] {
@@ -250,6 +394,13 @@ void waybar::modules::Network::worker() {
             thread_.stop();
             break;
           }
+          // One update for the whole batch of events
+          std::lock_guard<std::mutex> lock(mutex_);
+          updateEventFilter();
+          if (update_pending_) {
+            update_pending_ = false;
+            dp.emit();
+          }
         } else {
           thread_.stop();
           break;
@@ -308,6 +459,8 @@ auto waybar::modules::Network::update() -> void {
 
       bandwidth_down_prev_ = bandwidth_down;
       bandwidth_up_prev_ = bandwidth_up;
+      // Only fresh samples land in the graph, not the repeated ones of early updates
+      pushSample((bandwidth_down + bandwidth_up) / elapsed_seconds);
     }
   } else {
     bandwidth_down = bandwidth_down_prev_;
@@ -412,7 +565,7 @@ auto waybar::modules::Network::update() -> void {
   }
 
   // Call parent update
-  ALabel::update();
+  AGraph::update();
 }
 
 // https://gist.github.com/rressi/92af77630faf055934c723ce93ae2495
@@ -529,7 +682,7 @@ int waybar::modules::Network::handleEvents(struct nl_msg* msg, void* data) {
         // it have been deleted, so start looking for a new default route.
         spdlog::debug("network: if{} down", net->ifid_);
         net->clearIface();
-        net->dp.emit();
+        net->update_pending_ = true;
         net->want_route_dump_ = true;
         net->askForStateDump();
         return NL_OK;
@@ -616,7 +769,7 @@ int waybar::modules::Network::handleEvents(struct nl_msg* msg, void* data) {
         spdlog::debug("network: interface {}/{} deleted", net->ifname_, net->ifid_);
 
         net->clearIface();
-        net->dp.emit();
+        net->update_pending_ = true;
       }
       break;
     }
@@ -706,7 +859,7 @@ int waybar::modules::Network::handleEvents(struct nl_msg* msg, void* data) {
                             inet_ntop(ifa->ifa_family, RTA_DATA(ifa_rta), ipaddr, sizeof(ipaddr)),
                             ifa->ifa_prefixlen);
             }
-            net->dp.emit();
+            net->update_pending_ = true;
             break;
         }
       }
@@ -827,7 +980,7 @@ int waybar::modules::Network::handleEvents(struct nl_msg* msg, void* data) {
                         priority);
 
           net->clearIface();
-          net->dp.emit();
+          net->update_pending_ = true;
           /* Ask for a dump of all routes in case another one is already
            * setup. If there's none, there'll be an event with new one
            * later. */
@@ -93,47 +93,50 @@ Privacy::Privacy(const std::string& id, const Json::Value& config, Gtk::Orientat
   }
 
   backend = util::PipewireBackend::PipewireBackend::getInstance();
-  backend->privacy_nodes_changed_signal_event.connect(
-      sigc::mem_fun(*this, &Privacy::onPrivacyNodesChanged));
+  subscription_ = backend->subscribe(
+      [this](const PrivacyNodeChange& change) { onPrivacyNodeChanged(change); });
 
   dp.emit();
 }
 
-void Privacy::onPrivacyNodesChanged() {
-  mutex_.lock();
-  nodes_audio_out.clear();
-  nodes_audio_in.clear();
-  nodes_screenshare.clear();
-
-  for (auto& node : backend->privacy_nodes) {
-    if (ignore_monitor && node.second->is_monitor) continue;
-
-    auto iter = ignore.find(std::pair(node.second->type, node.second->node_name));
-    if (iter != ignore.end()) continue;
-
-    switch (node.second->state) {
-      case PW_NODE_STATE_RUNNING:
-        switch (node.second->type) {
-          case PRIVACY_NODE_TYPE_VIDEO_INPUT:
-            nodes_screenshare.push_back(node.second);
-            break;
-          case PRIVACY_NODE_TYPE_AUDIO_INPUT:
-            nodes_audio_in.push_back(node.second);
-            break;
-          case PRIVACY_NODE_TYPE_AUDIO_OUTPUT:
-            nodes_audio_out.push_back(node.second);
-            break;
-          case PRIVACY_NODE_TYPE_NONE:
-            continue;
-        }
-        break;
-      default:
-        break;
-    }
+Privacy::~Privacy() { backend->unsubscribe(subscription_); }
+
+void Privacy::onPrivacyNodeChanged(const PrivacyNodeChange& change) {
+  const auto& node = change.node;
+  PrivacyNodes* nodes = nullptr;
+  switch (node.type) {
+    case PRIVACY_NODE_TYPE_VIDEO_INPUT:
+      nodes = &nodes_screenshare;
+      break;
+    case PRIVACY_NODE_TYPE_AUDIO_INPUT:
+      nodes = &nodes_audio_in;
+      break;
+    case PRIVACY_NODE_TYPE_AUDIO_OUTPUT:
+      nodes = &nodes_audio_out;
+      break;
+    case PRIVACY_NODE_TYPE_NONE:
+      return;
   }
 
+  bool in_use = change.kind != PrivacyNodeChange::Kind::Removed &&
+                node.state == PW_NODE_STATE_RUNNING && !(ignore_monitor && node.is_monitor) &&
+                !ignore.contains(std::pair(node.type, node.node_name));
+
+  bool changed = false;
+  mutex_.lock();
+  if (in_use) {
+    auto [iter, inserted] = nodes->try_emplace(node.id, node);
+    changed = inserted || iter->second != node;
+    iter->second = node;
+  } else {
+    changed = nodes->erase(node.id) > 0;
+  }
   mutex_.unlock();
-  dp.emit();
+
+  // Nodes starting, stopping or renaming outside of the in-use sets don't wake the module up
+  if (changed) {
+    dp.emit();
+  }
 }
 
 auto Privacy::update() -> void {
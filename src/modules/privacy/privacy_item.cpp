@@ -13,9 +13,8 @@
 namespace waybar::modules::privacy {
 
 PrivacyItem::PrivacyItem(const Json::Value& config_, enum PrivacyNodeType privacy_type_,
-                         std::list<PrivacyNodeInfo*>* nodes_, Gtk::Orientation orientation,
-                         const std::string& pos, const uint icon_size,
-                         const uint transition_duration)
+                         PrivacyNodes* nodes_, Gtk::Orientation orientation, const std::string& pos,
+                         const uint icon_size, const uint transition_duration)
     : Gtk::Revealer(),
       privacy_type(privacy_type_),
       nodes(nodes_),
@@ -103,17 +102,17 @@ void PrivacyItem::update_tooltip() {
     // work differently in GTK4.
     delete child;
   }
-  for (auto* node : *nodes) {
+  for (const auto& [_, node] : *nodes) {
     auto* box = Gtk::make_managed<Gtk::Box>(Gtk::ORIENTATION_HORIZONTAL, 4);
 
     // Set device icon
     auto* node_icon = Gtk::make_managed<Gtk::Image>();
     node_icon->set_pixel_size(tooltipIconSize);
-    node_icon->set_from_icon_name(node->getIconName(), Gtk::ICON_SIZE_INVALID);
+    node_icon->set_from_icon_name(node.getIconName(), Gtk::ICON_SIZE_INVALID);
     box->add(*node_icon);
 
     // Set model
-    auto* nodeName = Gtk::make_managed<Gtk::Label>(node->getName());
+    auto* nodeName = Gtk::make_managed<Gtk::Label>(node.getName());
     box->add(*nodeName);
 
     tooltip_window.add(*box);
@@ -0,0 +1,141 @@
+#include "modules/psi.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <spdlog/spdlog.h>
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+// In the 80000 version of fmt library authors decided to optimize imports
+// and moved declarations required for fmt::dynamic_format_arg_store in new
+// header fmt/args.h
+#if (FMT_VERSION >= 80000)
+#include <fmt/args.h>
+#else
+#include <fmt/core.h>
+#endif
+
+#include "util/pressure.hpp"
+
+namespace waybar::modules {
+
+Psi::Psi(const std::string& id, const Json::Value& config)
+    : ALabel(config, "psi", id, "{some_avg10}%", 10),
+      resource_(config_["resource"].isString() ? config_["resource"].asString() : "cpu") {
+  if (resource_ != "cpu" && resource_ != "memory" && resource_ != "io") {
+    throw std::runtime_error("psi: unknown resource " + resource_);
+  }
+  path_ = std::filesystem::path("/proc/pressure") / resource_;
+  file_ = util::SysfsFile(path_);
+  if (!file_.isOpen()) {
+    throw std::runtime_error("Can't open " + path_.string());
+  }
+
+  if (!config_["trigger"].isBool() || config_["trigger"].asBool()) {
+    registerTrigger(config_["trigger"].isString() ? config_["trigger"].asString()
+                                                  : "some 150000 1000000");
+  }
+  worker();
+}
+
+void Psi::registerTrigger(const std::string& trigger) {
+  // Returns 0 or the errno of the failed registration
+  auto tryRegister = [this](const std::string& spec) {
+    util::ScopedFd fd(open(path_.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC));
+    if (fd == -1 || write(fd, spec.c_str(), spec.size() + 1) < 0) {
+      return errno;
+    }
+    trigger_fd_ = std::move(fd);
+    return 0;
+  };
+  int error = tryRegister(trigger);
+  if (error == 0) {
+    return;
+  }
+
+  auto unprivileged = error == EINVAL ? util::unprivilegedTrigger(trigger) : std::nullopt;
+  if (unprivileged) {
+    error = tryRegister(*unprivileged);
+    if (error == 0) {
+      spdlog::debug("psi: registered trigger \"{}\" instead of \"{}\"", *unprivileged, trigger);
+      return;
+    }
+  }
+  spdlog::warn("psi: can't register trigger \"{}\" on {}, polling instead: {}", trigger,
+               path_.string(), strerror(error));
+}
+
+void Psi::worker() {
+  thread_ = [this] {
+    dp.emit();
+    if (trigger_fd_ == -1) {
+      thread_.sleep_for(interval_);
+      return;
+    }
+    // Nothing happens until the kernel reports a stall, unless the averages are still decaying
+    int timeout = -1;
+    if (stalling_ && interval_.count() <= std::numeric_limits<int>::max()) {
+      timeout = interval_.count();
+    }
+    pollfd pfd{.fd = trigger_fd_, .events = POLLPRI, .revents = 0};
+    int ret = poll(&pfd, 1, timeout);
+    if ((ret < 0 && errno != EINTR) || (pfd.revents & POLLERR) != 0) {
+      spdlog::warn("psi: trigger on {} failed, polling instead", path_.string());
+      trigger_fd_.reset();
+    }
+  };
+}
+
+auto Psi::update() -> void {
+  auto contents = file_.read();
+  if (!contents) {
+    spdlog::error("psi: can't read {}", path_.string());
+    return;
+  }
+  auto [some, full] = util::parsePressure(*contents);
+  // avg60 and avg300 take many minutes to decay and rarely reach zero on a desktop, so only the
+  // average the module is driven by keeps it polling
+  stalling_ = some.avg10 > 0;
+
+  auto format = format_;
+  auto state = getState(some.avg10);
+  if (!state.empty() && config_["format-" + state].isString()) {
+    format = config_["format-" + state].asString();
+  }
+
+  fmt::dynamic_format_arg_store<fmt::format_context> store;
+  store.push_back(fmt::arg("resource", resource_));
+  store.push_back(fmt::arg("icon", getIcon(some.avg10, std::vector<std::string>{state})));
+  store.push_back(fmt::arg("some_avg10", some.avg10));
+  store.push_back(fmt::arg("some_avg60", some.avg60));
+  store.push_back(fmt::arg("some_avg300", some.avg300));
+  store.push_back(fmt::arg("some_total", some.total / 1e6));
+  store.push_back(fmt::arg("full_avg10", full.avg10));
+  store.push_back(fmt::arg("full_avg60", full.avg60));
+  store.push_back(fmt::arg("full_avg300", full.avg300));
+  store.push_back(fmt::arg("full_total", full.total / 1e6));
+
+  if (format.empty()) {
+    event_box_.hide();
+  } else {
+    event_box_.show();
+    label_.set_markup(fmt::vformat(format, store));
+  }
+
+  if (tooltipEnabled()) {
+    if (config_["tooltip-format"].isString()) {
+      label_.set_tooltip_markup(fmt::vformat(config_["tooltip-format"].asString(), store));
+    } else {
+      label_.set_tooltip_markup(fmt::format(
+          "{} pressure\nsome: {:.2f}% {:.2f}% {:.2f}%\nfull: {:.2f}% {:.2f}% {:.2f}%", resource_,
+          some.avg10, some.avg60, some.avg300, full.avg10, full.avg60, full.avg300));
+    }
+  }
+
+  // Call parent update
+  ALabel::update();
+}
+
+}  // namespace waybar::modules
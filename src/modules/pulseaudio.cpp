@@ -5,19 +5,32 @@ waybar::modules::Pulseaudio::Pulseaudio(const std::string& id, const Json::Value
   event_box_.add_events(Gdk::SCROLL_MASK | Gdk::SMOOTH_SCROLL_MASK);
   event_box_.signal_scroll_event().connect(sigc::mem_fun(*this, &Pulseaudio::handleScroll));
 
-  backend = util::AudioBackend::getInstance([this] { this->dp.emit(); });
+  backend = util::AudioBackend::getInstance();
   backend->setIgnoredSinks(config_["ignored-sinks"]);
+  subscription_ = backend->subscribe(util::AudioTarget::Both, [this] { this->dp.emit(); });
 }
 
+waybar::modules::Pulseaudio::~Pulseaudio() { backend->unsubscribe(subscription_); }
+
 bool waybar::modules::Pulseaudio::handleScroll(GdkEventScroll* e) {
   // change the pulse volume only when no user provided
   // events are configured
   if (config_["on-scroll-up"].isString() || config_["on-scroll-down"].isString()) {
     return AModule::handleScroll(e);
   }
-  auto dir = AModule::getScrollDir(e);
-  if (dir == SCROLL_DIR::NONE) {
-    return true;
+  queueScroll(AModule::getScrollDir(e));
+  return true;
+}
+
+void waybar::modules::Pulseaudio::handleScrollSteps(const ScrollSteps& steps) {
+  if (config_["on-scroll-up"].isString() || config_["on-scroll-down"].isString()) {
+    AModule::handleScrollSteps(steps);
+    return;
+  }
+  // Up and right raise the volume, a whole window of steps is applied as one change
+  const int net = steps.vertical + steps.horizontal;
+  if (net == 0) {
+    return;
   }
   int max_volume = 100;
   double step = 1;
@@ -29,12 +42,9 @@ bool waybar::modules::Pulseaudio::handleScroll(GdkEventScroll* e) {
     max_volume = config_["max-volume"].asInt();
   }
 
-  auto change_type = (dir == SCROLL_DIR::UP || dir == SCROLL_DIR::RIGHT)
-                         ? util::ChangeType::Increase
-                         : util::ChangeType::Decrease;
+  auto change_type = net > 0 ? util::ChangeType::Increase : util::ChangeType::Decrease;
 
-  backend->changeVolume(change_type, step, max_volume);
-  return true;
+  backend->changeVolume(change_type, step * std::abs(net), max_volume);
 }
 
 static const std::array<std::string, 9> ports = {
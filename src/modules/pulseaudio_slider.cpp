@@ -4,9 +4,6 @@ namespace waybar::modules {
 
 PulseaudioSlider::PulseaudioSlider(const std::string& id, const Json::Value& config)
     : ASlider(config, "pulseaudio-slider", id) {
-  backend = util::AudioBackend::getInstance([this] { this->dp.emit(); });
-  backend->setIgnoredSinks(config_["ignored-sinks"]);
-
   if (config_["target"].isString()) {
     std::string target = config_["target"].asString();
     if (target == "sink") {
@@ -15,23 +12,36 @@ PulseaudioSlider::PulseaudioSlider(const std::string& id, const Json::Value& con
       this->target = PulseaudioSliderTarget::Source;
     }
   }
+
+  backend = util::AudioBackend::getInstance();
+  backend->setIgnoredSinks(config_["ignored-sinks"]);
+  // Only redraw for changes of the side the slider controls
+  auto audio_target = target == PulseaudioSliderTarget::Sink ? util::AudioTarget::Sink
+                                                             : util::AudioTarget::Source;
+  subscription_ = backend->subscribe(audio_target, [this] { this->dp.emit(); });
 }
 
+PulseaudioSlider::~PulseaudioSlider() { backend->unsubscribe(subscription_); }
+
 void PulseaudioSlider::update() {
+  // Don't move the slider away from a value the user is still setting
+  if (value_coalescer_.pending()) {
+    return;
+  }
   switch (target) {
     case PulseaudioSliderTarget::Sink:
       if (backend->getSinkMuted()) {
-        scale_.set_value(min_);
+        setValue(min_);
       } else {
-        scale_.set_value(backend->getSinkVolume());
+        setValue(backend->getSinkVolume());
       }
       break;
 
     case PulseaudioSliderTarget::Source:
       if (backend->getSourceMuted()) {
-        scale_.set_value(min_);
+        setValue(min_);
       } else {
-        scale_.set_value(backend->getSourceVolume());
+        setValue(backend->getSourceVolume());
       }
       break;
   }
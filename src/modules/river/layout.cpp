@@ -67,54 +67,29 @@ static const zriver_seat_status_v1_listener seat_status_listener_impl{
     .mode = listen_mode,
 };
 
-static void handle_global(void* data, struct wl_registry* registry, uint32_t name,
-                          const char* interface, uint32_t version) {
-  if (std::strcmp(interface, zriver_status_manager_v1_interface.name) == 0) {
-    version = std::min<uint32_t>(version, 4);
-
-    // implies ZRIVER_OUTPUT_STATUS_V1_LAYOUT_NAME_CLEAR_SINCE_VERSION
-    if (version < ZRIVER_OUTPUT_STATUS_V1_LAYOUT_NAME_SINCE_VERSION) {
-      spdlog::error(
-          "river server does not support the \"layout_name\" and \"layout_clear\" events; the "
-          "module will be disabled" +
-          std::to_string(version));
-      return;
-    }
-    static_cast<Layout*>(data)->status_manager_ = static_cast<struct zriver_status_manager_v1*>(
-        wl_registry_bind(registry, name, &zriver_status_manager_v1_interface, version));
-  }
-
-  if (std::strcmp(interface, wl_seat_interface.name) == 0) {
-    version = std::min<uint32_t>(version, 1);
-    static_cast<Layout*>(data)->seat_ =
-        static_cast<struct wl_seat*>(wl_registry_bind(registry, name, &wl_seat_interface, version));
-  }
-}
-
-static void handle_global_remove(void* data, struct wl_registry* registry, uint32_t name) {
-  // Nobody cares
-}
-
-static const wl_registry_listener registry_listener_impl = {.global = handle_global,
-                                                            .global_remove = handle_global_remove};
-
 Layout::Layout(const std::string& id, const waybar::Bar& bar, const Json::Value& config)
     : waybar::ALabel(config, "layout", id, "{}"),
-      status_manager_{nullptr},
-      seat_{nullptr},
       bar_(bar),
       output_status_{nullptr} {
-  struct wl_display* display = Client::inst()->wl_display;
-  struct wl_registry* registry = wl_display_get_registry(display);
-  wl_registry_add_listener(registry, &registry_listener_impl, this);
-  wl_display_roundtrip(display);
-
   output_ = gdk_wayland_monitor_get_wl_output(bar_.output->monitor->gobj());
 
-  if (!status_manager_) {
+  auto& globals = Client::inst()->globals;
+  auto version = globals.version(zriver_status_manager_v1_interface);
+  if (version == 0) {
     spdlog::error("river_status_manager_v1 not advertised");
     return;
   }
+  // implies ZRIVER_OUTPUT_STATUS_V1_LAYOUT_NAME_CLEAR_SINCE_VERSION
+  if (version < ZRIVER_OUTPUT_STATUS_V1_LAYOUT_NAME_SINCE_VERSION) {
+    spdlog::error(
+        "river server does not support the \"layout_name\" and \"layout_clear\" events; the "
+        "module will be disabled" +
+        std::to_string(version));
+    return;
+  }
+  status_manager_ = globals.acquire(zriver_status_manager_v1_interface, 4,
+                                    &zriver_status_manager_v1_destroy);
+  seat_ = globals.acquire(wl_seat_interface, 1, &wl_seat_destroy);
 
   if (!seat_) {
     spdlog::error("wl_seat not advertised");
@@ -124,13 +99,13 @@ Layout::Layout(const std::string& id, const waybar::Bar& bar, const Json::Value&
   label_.hide();
   ALabel::update();
 
-  seat_status_ = zriver_status_manager_v1_get_river_seat_status(status_manager_, seat_);
+  seat_status_ =
+      zriver_status_manager_v1_get_river_seat_status(status_manager_.get(), seat_.get());
   zriver_seat_status_v1_add_listener(seat_status_, &seat_status_listener_impl, this);
 
-  output_status_ = zriver_status_manager_v1_get_river_output_status(status_manager_, output_);
+  output_status_ =
+      zriver_status_manager_v1_get_river_output_status(status_manager_.get(), output_);
   zriver_output_status_v1_add_listener(output_status_, &output_status_listener_impl, this);
-
-  zriver_status_manager_v1_destroy(status_manager_);
 }
 
 Layout::~Layout() {
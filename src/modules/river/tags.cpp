@@ -50,49 +50,16 @@ static const zriver_command_callback_v1_listener command_callback_listener_impl{
     .failure = listen_command_failure,
 };
 
-static void handle_global(void* data, struct wl_registry* registry, uint32_t name,
-                          const char* interface, uint32_t version) {
-  if (std::strcmp(interface, zriver_status_manager_v1_interface.name) == 0) {
-    version = std::min(version, 2u);
-    if (version < ZRIVER_OUTPUT_STATUS_V1_URGENT_TAGS_SINCE_VERSION) {
-      spdlog::warn("river server does not support urgent tags");
-    }
-    static_cast<Tags*>(data)->status_manager_ = static_cast<struct zriver_status_manager_v1*>(
-        wl_registry_bind(registry, name, &zriver_status_manager_v1_interface, version));
-  }
-
-  if (std::strcmp(interface, zriver_control_v1_interface.name) == 0) {
-    version = std::min(version, 1u);
-    static_cast<Tags*>(data)->control_ = static_cast<struct zriver_control_v1*>(
-        wl_registry_bind(registry, name, &zriver_control_v1_interface, version));
-  }
-
-  if (std::strcmp(interface, wl_seat_interface.name) == 0) {
-    version = std::min(version, 1u);
-    static_cast<Tags*>(data)->seat_ =
-        static_cast<struct wl_seat*>(wl_registry_bind(registry, name, &wl_seat_interface, version));
-  }
-}
-
-static void handle_global_remove(void* data, struct wl_registry* registry, uint32_t name) {
-  /* Ignore event */
-}
-
-static const wl_registry_listener registry_listener_impl = {.global = handle_global,
-                                                            .global_remove = handle_global_remove};
-
 Tags::Tags(const std::string& id, const waybar::Bar& bar, const Json::Value& config)
     : waybar::AModule(config, "tags", id, false, false),
-      status_manager_{nullptr},
-      control_{nullptr},
-      seat_{nullptr},
       bar_(bar),
       box_{bar.orientation, 0},
       output_status_{nullptr} {
-  struct wl_display* display = Client::inst()->wl_display;
-  struct wl_registry* registry = wl_display_get_registry(display);
-  wl_registry_add_listener(registry, &registry_listener_impl, this);
-  wl_display_roundtrip(display);
+  auto& globals = Client::inst()->globals;
+  status_manager_ = globals.acquire(zriver_status_manager_v1_interface, 2,
+                                    &zriver_status_manager_v1_destroy);
+  control_ = globals.acquire(zriver_control_v1_interface, 1, &zriver_control_v1_destroy);
+  seat_ = globals.acquire(wl_seat_interface, 1, &wl_seat_destroy);
 
   if (!status_manager_) {
     spdlog::error("river_status_manager_v1 not advertised");
@@ -109,6 +76,11 @@ Tags::Tags(const std::string& id, const waybar::Bar& bar, const Json::Value& con
     return;
   }
 
+  if (zriver_status_manager_v1_get_version(status_manager_.get()) <
+      ZRIVER_OUTPUT_STATUS_V1_URGENT_TAGS_SINCE_VERSION) {
+    spdlog::warn("river server does not support urgent tags");
+  }
+
   box_.set_name("tags");
   if (!id.empty()) {
     box_.get_style_context()->add_class(id);
@@ -159,32 +131,24 @@ Tags::~Tags() {
   if (output_status_) {
     zriver_output_status_v1_destroy(output_status_);
   }
-
-  if (control_) {
-    zriver_control_v1_destroy(control_);
-  }
-
-  if (status_manager_) {
-    zriver_status_manager_v1_destroy(status_manager_);
-  }
 }
 
 void Tags::handle_show() {
   if (!status_manager_) return;
   struct wl_output* output = gdk_wayland_monitor_get_wl_output(bar_.output->monitor->gobj());
-  output_status_ = zriver_status_manager_v1_get_river_output_status(status_manager_, output);
+  output_status_ =
+      zriver_status_manager_v1_get_river_output_status(status_manager_.get(), output);
   zriver_output_status_v1_add_listener(output_status_, &output_status_listener_impl, this);
 
-  zriver_status_manager_v1_destroy(status_manager_);
-  status_manager_ = nullptr;
+  status_manager_.reset();
 }
 
 void Tags::handle_primary_clicked(uint32_t tag) {
   // Send river command to select tag on left mouse click
   zriver_command_callback_v1* callback;
-  zriver_control_v1_add_argument(control_, "set-focused-tags");
-  zriver_control_v1_add_argument(control_, std::to_string(tag).c_str());
-  callback = zriver_control_v1_run_command(control_, seat_);
+  zriver_control_v1_add_argument(control_.get(), "set-focused-tags");
+  zriver_control_v1_add_argument(control_.get(), std::to_string(tag).c_str());
+  callback = zriver_control_v1_run_command(control_.get(), seat_.get());
   zriver_command_callback_v1_add_listener(callback, &command_callback_listener_impl, nullptr);
 }
 
@@ -192,9 +156,9 @@ bool Tags::handle_button_press(GdkEventButton* event_button, uint32_t tag) {
   if (event_button->type == GDK_BUTTON_PRESS && event_button->button == 3) {
     // Send river command to toggle tag on right mouse click
     zriver_command_callback_v1* callback;
-    zriver_control_v1_add_argument(control_, "toggle-focused-tags");
-    zriver_control_v1_add_argument(control_, std::to_string(tag).c_str());
-    callback = zriver_control_v1_run_command(control_, seat_);
+    zriver_control_v1_add_argument(control_.get(), "toggle-focused-tags");
+    zriver_control_v1_add_argument(control_.get(), std::to_string(tag).c_str());
+    callback = zriver_control_v1_run_command(control_.get(), seat_.get());
     zriver_command_callback_v1_add_listener(callback, &command_callback_listener_impl, nullptr);
   }
   return true;
@@ -12,8 +12,11 @@
 
 #include "gdk/gdk.h"
 #include "modules/sni/icon_manager.hpp"
+#include "modules/sni/icon_theme_registry.hpp"
+#include "util/argb_pixmap.hpp"
 #include "util/format.hpp"
 #include "util/gtk_icon.hpp"
+#include "util/icon_surface_cache.hpp"
 
 template <>
 struct fmt::formatter<Glib::VariantBase> : formatter<std::string> {
@@ -45,7 +48,6 @@ Item::Item(const std::string& bn, const std::string& op, const Json::Value& conf
       object_path(op),
       icon_size(16),
       effective_icon_size(0),
-      icon_theme(Gtk::IconTheme::create()),
       bar_(bar),
       on_ready_(on_ready),
       on_invalidate_(on_invalidate),
@@ -192,15 +194,17 @@ void Item::setProperty(const Glib::ustring& name, Glib::VariantBase& value) {
     } else if (name == "IconName") {
       icon_name = get_variant<std::string>(value);
     } else if (name == "IconPixmap") {
-      icon_pixmap = this->extractPixBuf(value.gobj());
+      icon_pixmap = extractPixBuf(value.gobj(), icon_pixmap_hash_, icon_pixmap);
     } else if (name == "OverlayIconName") {
       overlay_icon_name = get_variant<std::string>(value);
     } else if (name == "OverlayIconPixmap") {
-      overlay_icon_pixmap = extractPixBuf(value.gobj());
+      overlay_icon_pixmap =
+          extractPixBuf(value.gobj(), overlay_icon_pixmap_hash_, overlay_icon_pixmap);
     } else if (name == "AttentionIconName") {
       attention_icon_name = get_variant<std::string>(value);
     } else if (name == "AttentionIconPixmap") {
-      attention_icon_pixmap = extractPixBuf(value.gobj());
+      attention_icon_pixmap =
+          extractPixBuf(value.gobj(), attention_icon_pixmap_hash_, attention_icon_pixmap);
     } else if (name == "AttentionMovieName") {
       attention_movie_name = get_variant<std::string>(value);
     } else if (name == "ToolTip") {
@@ -211,7 +215,9 @@ void Item::setProperty(const Glib::ustring& name, Glib::VariantBase& value) {
     } else if (name == "IconThemePath") {
       icon_theme_path = get_variant<std::string>(value);
       if (!icon_theme_path.empty()) {
-        icon_theme->set_search_path({icon_theme_path});
+        icon_theme = IconThemeRegistry::instance().getTheme(icon_theme_path);
+      } else {
+        icon_theme.reset();
       }
     } else if (name == "Menu") {
       menu = get_variant<std::string>(value);
@@ -270,6 +276,7 @@ void Item::setCustomIcon(const std::string& id) {
         Glib::RefPtr<Gdk::Pixbuf> custom_pixbuf = Gdk::Pixbuf::create_from_file(custom_icon);
         icon_name = "";  // icon_name has priority over pixmap
         icon_pixmap = custom_pixbuf;
+        icon_pixmap_hash_ = std::hash<std::string>{}(custom_icon);
       } catch (const Glib::Error& e) {
         spdlog::error("Failed to load custom icon {}: {}", custom_icon, e.what());
       }
@@ -280,33 +287,43 @@ void Item::setCustomIcon(const std::string& id) {
 }
 
 void Item::getUpdatedProperties() {
-  auto params = Glib::VariantContainerBase::create_tuple(
-      {Glib::Variant<Glib::ustring>::create(SNI_INTERFACE_NAME)});
-  proxy_->call("org.freedesktop.DBus.Properties.GetAll",
-               sigc::mem_fun(*this, &Item::processUpdatedProperties), params);
+  /* Fetch only the properties that may have changed instead of GetAll, so that e.g. a NewToolTip
+   * signal doesn't transfer the full IconPixmap set again. The Get calls are issued together and
+   * the image is updated once after the last reply.
+   */
+  auto remaining = std::make_shared<size_t>(update_pending_.size());
+  for (const auto& name : update_pending_) {
+    auto params = Glib::VariantContainerBase::create_tuple(
+        {Glib::Variant<Glib::ustring>::create(SNI_INTERFACE_NAME),
+         Glib::Variant<Glib::ustring>::create(std::string(name))});
+    proxy_->call("org.freedesktop.DBus.Properties.Get",
+                 sigc::bind(sigc::mem_fun(*this, &Item::processUpdatedProperty),
+                            Glib::ustring(std::string(name)), remaining),
+                 params);
+  }
+  update_pending_.clear();
 };
 
-void Item::processUpdatedProperties(Glib::RefPtr<Gio::AsyncResult>& _result) {
+void Item::processUpdatedProperty(Glib::RefPtr<Gio::AsyncResult>& _result,
+                                  const Glib::ustring& name,
+                                  const std::shared_ptr<size_t>& remaining) {
   try {
     auto result = proxy_->call_finish(_result);
-    // extract "a{sv}" from VariantContainerBase
-    Glib::Variant<std::map<Glib::ustring, Glib::VariantBase>> properties_variant;
-    result.get_child(properties_variant);
-    auto properties = properties_variant.get();
-
-    for (const auto& [name, value] : properties) {
-      if (update_pending_.count(name.raw())) {
-        setProperty(name, const_cast<Glib::VariantBase&>(value));
-      }
-    }
-
-    this->updateImage();
+    // extract "v" from "(v)"
+    Glib::Variant<Glib::VariantBase> value_variant;
+    result.get_child(value_variant);
+    auto value = value_variant.get();
+    setProperty(name, value);
   } catch (const Glib::Error& err) {
-    spdlog::warn("Failed to update properties: {}", err.what());
+    // Items are not required to implement every property
+    spdlog::debug("Failed to update property {}.{}: {}", id, name, err.what());
   } catch (const std::exception& err) {
-    spdlog::warn("Failed to update properties: {}", err.what());
+    spdlog::warn("Failed to update property {}.{}: {}", id, name, err.what());
+  }
+
+  if (--*remaining == 0) {
+    this->updateImage();
   }
-  update_pending_.clear();
 }
 
 /**
@@ -342,78 +359,124 @@ void Item::onSignal(const Glib::ustring& sender_name, const Glib::ustring& signa
 
 static void pixbuf_data_deleter(const guint8* data) { g_free((void*)data); }
 
-Glib::RefPtr<Gdk::Pixbuf> Item::extractPixBuf(GVariant* variant) {
-  GVariantIter* it;
-  g_variant_get(variant, "a(iiay)", &it);
-  if (it == nullptr) {
+Glib::RefPtr<Gdk::Pixbuf> Item::extractPixBuf(GVariant* variant, uint64_t& hash,
+                                              const Glib::RefPtr<Gdk::Pixbuf>& current) {
+  if (variant == nullptr || !g_variant_is_of_type(variant, G_VARIANT_TYPE("a(iiay)"))) {
+    hash = 0;
+    return Glib::RefPtr<Gdk::Pixbuf>{};
+  }
+
+  std::vector<util::PixmapSize> sizes;
+  std::vector<gsize> children;
+  gsize n_children = g_variant_n_children(variant);
+  for (gsize i = 0; i < n_children; i++) {
+    gint width;
+    gint height;
+    GVariant* val = nullptr;
+    g_variant_get_child(variant, i, "(ii@ay)", &width, &height, &val);
+    /* Sanity check */
+    if (width > 0 && height > 0 && val != nullptr &&
+        g_variant_get_size(val) == 4U * width * height) {
+      sizes.push_back({width, height});
+      children.push_back(i);
+    }
+    if (val != nullptr) {
+      g_variant_unref(val);
+    }
+  }
+
+  /* Pick the frame closest to the icon size rather than the largest one, so that large
+   * pixmap sets don't get converted and downscaled on every refresh. */
+  int best = util::selectPixmapFrame(sizes, static_cast<int>(getScaledIconSize()));
+  if (best < 0) {
+    hash = 0;
     return Glib::RefPtr<Gdk::Pixbuf>{};
   }
-  GVariant* val;
-  gint lwidth = 0;
-  gint lheight = 0;
+
   gint width;
   gint height;
-  guchar* array = nullptr;
-  while (g_variant_iter_loop(it, "(ii@ay)", &width, &height, &val)) {
-    if (width > 0 && height > 0 && val != nullptr && width * height > lwidth * lheight) {
-      auto size = g_variant_get_size(val);
-      /* Sanity check */
-      if (size == 4U * width * height) {
-        /* Find the largest image */
-        gconstpointer data = g_variant_get_data(val);
-        if (data != nullptr) {
-          if (array != nullptr) {
-            g_free(array);
-          }
-          // We must allocate our own array because the data from GVariant is read-only
-          // and we need to modify it to convert ARGB to RGBA.
-          array = static_cast<guchar*>(g_malloc(size));
-
-          // Copy and convert ARGB to RGBA in one pass to avoid g_memdup2 overhead
-          const guchar* src = static_cast<const guchar*>(data);
-          for (gsize i = 0; i < size; i += 4) {
-            guchar alpha = src[i];
-            array[i] = src[i + 1];
-            array[i + 1] = src[i + 2];
-            array[i + 2] = src[i + 3];
-            array[i + 3] = alpha;
-          }
-
-          lwidth = width;
-          lheight = height;
-        }
-      }
+  GVariant* val = nullptr;
+  g_variant_get_child(variant, children[best], "(ii@ay)", &width, &height, &val);
+  auto size = g_variant_get_size(val);
+  const auto* data = static_cast<const guint8*>(g_variant_get_data(val));
+  Glib::RefPtr<Gdk::Pixbuf> result;
+  if (data != nullptr) {
+    auto new_hash = util::hashBytes(data, size, (static_cast<uint64_t>(width) << 32) | height);
+    if (current && new_hash == hash) {
+      // Apps like to re-send identical pixmaps, keep the already converted one
+      result = current;
+    } else {
+      // We must allocate our own array because the data from GVariant is read-only
+      // and we need to modify it to convert ARGB to RGBA.
+      auto* array = static_cast<guchar*>(g_malloc(size));
+      util::argbToRgba(data, array, size);
+      result = Gdk::Pixbuf::create_from_data(array, Gdk::Colorspace::COLORSPACE_RGB, true, 8, width,
+                                             height, 4 * width, &pixbuf_data_deleter);
+      hash = new_hash;
     }
   }
-  g_variant_iter_free(it);
-  if (array != nullptr) {
-    return Gdk::Pixbuf::create_from_data(array, Gdk::Colorspace::COLORSPACE_RGB, true, 8, lwidth,
-                                         lheight, 4 * lwidth, &pixbuf_data_deleter);
-  }
-  return Glib::RefPtr<Gdk::Pixbuf>{};
+  g_variant_unref(val);
+  return result;
 }
 
 void Item::updateImage() {
-  auto pixbuf = getIconPixbuf();
-  if (!pixbuf) return;
-  auto scaled_icon_size = getScaledIconSize();
+  // Named icons can be shared with every other tray item and bar showing the same icon;
+  // pixmaps are per-item data and always go through the full pipeline below.
+  if (!icon_pixmap && !attention_icon_pixmap && !overlay_icon_pixmap) {
+    auto scale = image.get_scale_factor();
+    auto color = event_box.get_style_context()->get_color(event_box.get_state_flags());
+    util::IconSurfaceKey key{
+        fmt::format("{}\x1f{}\x1f{}\x1f{}\x1f{}", status_.raw(), icon_name, attention_icon_name,
+                    attention_movie_name, overlay_icon_name),
+        static_cast<int>(getScaledIconSize()), scale,
+        fmt::format("{}\x1f{}", icon_theme_path, color.to_string().raw())};
+    auto surface = util::IconSurfaceCache::getInstance().get(
+        key, [this] {
+          return overlayPixbufs(scaleToIconSize(getIconPixbuf()), getOverlayIconPixbuf());
+        });
+    if (surface) {
+      image.set(surface);
+    }
+    // The image no longer shows the last rendered pixmap
+    last_render_key_.clear();
+    return;
+  }
 
-  // If the loaded icon is not square, assume that the icon height should match the
-  // requested icon size, but the width is allowed to be different. As such, if the
-  // height of the image does not match the requested icon size, resize the icon such that
-  // the aspect ratio is maintained, but the height matches the requested icon size.
-  if (pixbuf->get_height() > 0 && pixbuf->get_height() != scaled_icon_size) {
-    int width = scaled_icon_size * pixbuf->get_width() / pixbuf->get_height();
-    pixbuf = pixbuf->scale_simple(width, scaled_icon_size, Gdk::InterpType::INTERP_BILINEAR);
+  // Skip rescaling when neither the pixmaps nor the target size changed since the last render
+  auto render_key = fmt::format("{}\x1f{}\x1f{}\x1f{}\x1f{}\x1f{}\x1f{}\x1f{}\x1f{}\x1f{}\x1f{}",
+                                icon_pixmap_hash_, attention_icon_pixmap_hash_,
+                                overlay_icon_pixmap_hash_, status_.raw(), icon_name,
+                                attention_icon_name, attention_movie_name, overlay_icon_name,
+                                icon_theme_path, getScaledIconSize(), image.get_scale_factor());
+  if (render_key == last_render_key_) {
+    return;
   }
 
-  pixbuf = overlayPixbufs(pixbuf, getOverlayIconPixbuf());
+  auto pixbuf = getIconPixbuf();
+  if (!pixbuf) return;
+  last_render_key_ = std::move(render_key);
+
+  // Overlays are drawn at their own size after scaling, so they are not resampled
+  pixbuf = overlayPixbufs(scaleToIconSize(pixbuf), getOverlayIconPixbuf());
 
   auto surface =
       Gdk::Cairo::create_surface_from_pixbuf(pixbuf, image.get_scale_factor(), image.get_window());
   image.set(surface);
 }
 
+// If the loaded icon is not square, assume that the icon height should match the
+// requested icon size, but the width is allowed to be different. As such, if the
+// height of the image does not match the requested icon size, resize the icon such that
+// the aspect ratio is maintained, but the height matches the requested icon size.
+Glib::RefPtr<Gdk::Pixbuf> Item::scaleToIconSize(const Glib::RefPtr<Gdk::Pixbuf>& pixbuf) {
+  auto scaled_icon_size = getScaledIconSize();
+  if (!pixbuf || pixbuf->get_height() <= 0 || pixbuf->get_height() == scaled_icon_size) {
+    return pixbuf;
+  }
+  int width = scaled_icon_size * pixbuf->get_width() / pixbuf->get_height();
+  return pixbuf->scale_simple(width, scaled_icon_size, Gdk::InterpType::INTERP_BILINEAR);
+}
+
 Glib::RefPtr<Gdk::Pixbuf> Item::getIconPixbuf() {
   if (status_ == "needsattention") {
     if (auto attention_pixbuf = getAttentionIconPixbuf()) {
@@ -511,7 +574,7 @@ Glib::RefPtr<Gdk::Pixbuf> Item::overlayPixbufs(const Glib::RefPtr<Gdk::Pixbuf>&
 }
 
 Glib::RefPtr<Gdk::Pixbuf> Item::getIconByName(const std::string& name, int request_size) {
-  if (!icon_theme_path.empty()) {
+  if (icon_theme) {
     auto icon_info = icon_theme->lookup_icon(name.c_str(), request_size,
                                              Gtk::IconLookupFlags::ICON_LOOKUP_FORCE_SIZE);
     if (icon_info) {
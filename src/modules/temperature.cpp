@@ -8,7 +8,8 @@
 #endif
 
 waybar::modules::Temperature::Temperature(const std::string& id, const Json::Value& config)
-    : ALabel(config, "temperature", id, "{temperatureC}°C", 10) {
+    : AGraph(config, "temperature", id, "{temperatureC}°C",
+             config["critical-threshold"].isInt() ? config["critical-threshold"].asInt() : 0, 10) {
 #if defined(__FreeBSD__)
 // FreeBSD uses sysctlbyname instead of read from a file
 #else
@@ -68,6 +69,7 @@ auto waybar::modules::Temperature::update() -> void {
   uint16_t temperature_c = std::round(temperature);
   uint16_t temperature_f = std::round(temperature * 1.8 + 32);
   uint16_t temperature_k = std::round(temperature + 273.15);
+  pushSample(temperature);
   auto critical = isCritical(temperature_c);
   auto warning = isWarning(temperature_c);
   auto format = format_;
@@ -106,7 +108,7 @@ auto waybar::modules::Temperature::update() -> void {
         fmt::arg("temperatureF", temperature_f), fmt::arg("temperatureK", temperature_k)));
   }
   // Call parent update
-  ALabel::update();
+  AGraph::update();
 }
 
 float waybar::modules::Temperature::getTemperature() {
@@ -1,19 +1,20 @@
 #include "modules/upower.hpp"
 
 #include <giomm/dbuswatchname.h>
+#include <glibmm/main.h>
 #include <gtkmm/tooltip.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+
 namespace waybar::modules {
 
 UPower::UPower(const std::string& id, const Json::Value& config)
     : AIconLabel(config, "upower", id, "{percentage}", 0, true, true, true), sleeping_{false} {
   box_.set_name(name_);
   box_.set_spacing(0);
-  // Tooltip box
-  contentBox_.set_orientation((box_.get_orientation() == Gtk::ORIENTATION_HORIZONTAL)
-                                  ? Gtk::ORIENTATION_VERTICAL
-                                  : Gtk::ORIENTATION_HORIZONTAL);
   // Get current theme
   gtkTheme_ = Gtk::IconTheme::get_default();
 
@@ -37,13 +38,25 @@ UPower::UPower(const std::string& id, const Json::Value& config)
   // Tooltip Spacing
   if (config_["tooltip-spacing"].isInt()) tooltip_spacing_ = config_["tooltip-spacing"].asInt();
 
+  // Tooltip box, rows are stacked across the bar
+  if (AModule::tooltipEnabled()) {
+    tooltip_ = std::make_unique<util::TooltipTree>(
+        (box_.get_orientation() == Gtk::ORIENTATION_HORIZONTAL) ? Gtk::ORIENTATION_VERTICAL
+                                                                : Gtk::ORIENTATION_HORIZONTAL,
+        tooltip_spacing_, iconSize_);
+    tooltip_->setFallbackIcon(NO_BATTERY);
+  }
+
   // Tooltip Padding
   if (config_["tooltip-padding"].isInt()) {
     tooltip_padding_ = config_["tooltip-padding"].asInt();
-    contentBox_.set_margin_top(tooltip_padding_);
-    contentBox_.set_margin_bottom(tooltip_padding_);
-    contentBox_.set_margin_left(tooltip_padding_);
-    contentBox_.set_margin_right(tooltip_padding_);
+    if (tooltip_) {
+      auto& contentBox{tooltip_->root()};
+      contentBox.set_margin_top(tooltip_padding_);
+      contentBox.set_margin_bottom(tooltip_padding_);
+      contentBox.set_margin_left(tooltip_padding_);
+      contentBox.set_margin_right(tooltip_padding_);
+    }
   }
 
   // Tooltip Format
@@ -84,6 +97,7 @@ UPower::UPower(const std::string& id, const Json::Value& config)
 }
 
 UPower::~UPower() {
+  tooltipRefresh_.disconnect();
   if (upDevice_.upDevice != NULL) g_object_unref(upDevice_.upDevice);
   if (upClient_ != NULL) g_object_unref(upClient_);
   if (subscrID_ > 0u) {
@@ -225,8 +239,8 @@ auto UPower::update() -> void {
 
   label_.set_markup(getText(upDevice_, format_));
   // Set icon
-  if (upDevice_.icon_name == NULL || !gtkTheme_->has_icon(upDevice_.icon_name))
-    upDevice_.icon_name = (char*)NO_BATTERY.c_str();
+  if (upDevice_.icon_name.empty() || !gtkTheme_->has_icon(upDevice_.icon_name))
+    upDevice_.icon_name = NO_BATTERY;
   image_.set_from_icon_name(upDevice_.icon_name, Gtk::ICON_SIZE_INVALID);
 
   box_.show();
@@ -295,10 +309,49 @@ void UPower::deviceRemoved_cb(UpClient* client, const gchar* objectPath, gpointe
 
 void UPower::deviceNotify_cb(UpDevice* device, GParamSpec* pspec, gpointer data) {
   UPower* up{static_cast<UPower*>(data)};
+  up->deviceChanged(device, pspec != NULL ? g_param_spec_get_name(pspec) : NULL);
   // Update the widget
   up->dp.emit();
 }
 
+// Properties shown in a tooltip row, directly or through tooltip-format
+static bool isTooltipProperty(std::string_view property) {
+  static constexpr std::string_view shown[]{"kind",         "state",         "percentage",
+                                            "icon-name",    "time-to-empty", "time-to-full",
+                                            "temperature",  "native-path",   "model"};
+  return std::find(std::begin(shown), std::end(shown), property) != std::end(shown);
+}
+
+void UPower::deviceChanged(UpDevice* device, const gchar* property) {
+  if (!tooltip_ || (property != NULL && !isTooltipProperty(property))) return;
+  const gchar* objectPath{up_device_get_object_path(device)};
+  if (objectPath == NULL) return;
+  std::lock_guard<std::mutex> guard{mutex_};
+  auto it{devices_.find(objectPath)};
+  // The display device has no row of its own
+  if (it == devices_.end() || it->second.upDevice != device) return;
+  changedDevices_.insert(it->first);
+  // UPower notifies once per property, the row is refreshed once for all of them
+  if (!tooltipRefresh_.connected()) {
+    tooltipRefresh_ = Glib::signal_idle().connect([this] {
+      refreshTooltipRows();
+      return false;
+    });
+  }
+}
+
+void UPower::refreshTooltipRows() {
+  std::lock_guard<std::mutex> guard{mutex_};
+  for (const auto& objectPath : changedDevices_) {
+    auto it{devices_.find(objectPath)};
+    if (it != devices_.end()) {
+      getUpDeviceInfo(it->second);
+      updateTooltipRow(it->first, it->second);
+    }
+  }
+  changedDevices_.clear();
+}
+
 void UPower::addDevice(UpDevice* device) {
   std::lock_guard<std::mutex> guard{mutex_};
 
@@ -319,10 +372,15 @@ void UPower::addDevice(UpDevice* device) {
       auto upDevice{devices_[objectPath]};
       if (G_IS_OBJECT(upDevice.upDevice)) g_object_unref(upDevice.upDevice);
       devices_.erase(objectPath);
+      if (tooltip_) tooltip_->remove(objectPath);
     }
 
     g_signal_connect(device, "notify", G_CALLBACK(deviceNotify_cb), this);
-    devices_.emplace(Devices::value_type(objectPath, upDevice));
+    auto& added{devices_.emplace(Devices::value_type(objectPath, upDevice)).first->second};
+    if (tooltip_) {
+      getUpDeviceInfo(added);
+      updateTooltipRow(objectPath, added);
+    }
   }
 }
 
@@ -333,6 +391,7 @@ void UPower::removeDevice(const gchar* objectPath) {
     if (G_IS_OBJECT(upDevice.upDevice)) g_object_unref(upDevice.upDevice);
     devices_.erase(objectPath);
   }
+  if (tooltip_) tooltip_->remove(objectPath);
 }
 
 void UPower::removeDevices() {
@@ -344,6 +403,7 @@ void UPower::removeDevices() {
       devices_.erase(it++);
     }
   }
+  if (tooltip_) tooltip_->clear();
 }
 
 // Removes all devices and adds the current devices
@@ -381,13 +441,11 @@ void UPower::setDisplayDevice() {
           thisPtr->getUpDeviceInfo(upDevice);
           upDevice_output displayDevice{NULL};
           if (!thisPtr->nativePath_.empty()) {
-            if (upDevice.nativePath == nullptr) return;
-            if (0 == std::strcmp(upDevice.nativePath, thisPtr->nativePath_.c_str())) {
+            if (upDevice.nativePath == thisPtr->nativePath_) {
               displayDevice = upDevice;
             }
           } else {
-            if (upDevice.model == nullptr) return;
-            if (0 == std::strcmp(upDevice.model, thisPtr->model_.c_str())) {
+            if (upDevice.model == thisPtr->model_) {
               displayDevice = upDevice;
             }
           }
@@ -405,11 +463,19 @@ void UPower::setDisplayDevice() {
 
 void UPower::getUpDeviceInfo(upDevice_output& upDevice_) {
   if (upDevice_.upDevice != NULL && G_IS_OBJECT(upDevice_.upDevice)) {
+    gchar* iconName{NULL};
+    gchar* nativePath{NULL};
+    gchar* model{NULL};
     g_object_get(upDevice_.upDevice, "kind", &upDevice_.kind, "state", &upDevice_.state,
-                 "percentage", &upDevice_.percentage, "icon-name", &upDevice_.icon_name,
-                 "time-to-empty", &upDevice_.time_empty, "time-to-full", &upDevice_.time_full,
-                 "temperature", &upDevice_.temperature, "native-path", &upDevice_.nativePath,
-                 "model", &upDevice_.model, NULL);
+                 "percentage", &upDevice_.percentage, "icon-name", &iconName, "time-to-empty",
+                 &upDevice_.time_empty, "time-to-full", &upDevice_.time_full, "temperature",
+                 &upDevice_.temperature, "native-path", &nativePath, "model", &model, NULL);
+    upDevice_.icon_name = iconName != NULL ? iconName : "";
+    upDevice_.nativePath = nativePath != NULL ? nativePath : "";
+    upDevice_.model = model != NULL ? model : "";
+    g_free(iconName);
+    g_free(nativePath);
+    g_free(model);
     spdlog::debug(
         "UPower. getUpDeviceInfo. kind: \"{0}\". state: \"{1}\". percentage: \"{2}\". \
 icon_name: \"{3}\". time-to-empty: \"{4}\". time-to-full: \"{5}\". temperature: \"{6}\". \
@@ -448,54 +514,24 @@ const Glib::ustring UPower::getText(const upDevice_output& upDevice_, const std:
   return ret;
 }
 
+void UPower::updateTooltipRow(const std::string& objectPath, upDevice_output& upDevice) {
+  if (upDevice.kind == UpDeviceKind::UP_DEVICE_KIND_UNKNOWN ||
+      upDevice.kind == UpDeviceKind::UP_DEVICE_KIND_LINE_POWER) {
+    tooltip_->remove(objectPath);
+    return;
+  }
+  // Device cell: icon from kind and label from model
+  tooltip_->setIcon(objectPath, 0, std::string(getDeviceIcon(upDevice.kind)));
+  tooltip_->setText(objectPath, 0, upDevice.model);
+  // User cell: icon from icon state and markup text
+  tooltip_->setIcon(objectPath, 1, upDevice.icon_name);
+  tooltip_->setMarkup(objectPath, 1, getText(upDevice, tooltipFormat_));
+}
+
 bool UPower::queryTooltipCb(int x, int y, bool keyboard_tooltip,
                             const Glib::RefPtr<Gtk::Tooltip>& tooltip) {
-  std::lock_guard<std::mutex> guard{mutex_};
-
-  // Clear content box
-  contentBox_.forall([this](Gtk::Widget& wg) { contentBox_.remove(wg); });
-
-  // Fill content box with the content
-  for (auto pairDev : devices_) {
-    // Get device info
-    getUpDeviceInfo(pairDev.second);
-
-    if (pairDev.second.kind != UpDeviceKind::UP_DEVICE_KIND_UNKNOWN &&
-        pairDev.second.kind != UpDeviceKind::UP_DEVICE_KIND_LINE_POWER) {
-      // Make box record
-      Gtk::Box* boxRec{new Gtk::Box{box_.get_orientation(), tooltip_spacing_}};
-      contentBox_.add(*boxRec);
-      Gtk::Box* boxDev{new Gtk::Box{box_.get_orientation()}};
-      Gtk::Box* boxUsr{new Gtk::Box{box_.get_orientation()}};
-      boxRec->add(*boxDev);
-      boxRec->add(*boxUsr);
-      // Construct device box
-      // Set icon from kind
-      std::string iconNameDev{getDeviceIcon(pairDev.second.kind)};
-      if (!gtkTheme_->has_icon(iconNameDev)) iconNameDev = (char*)NO_BATTERY.c_str();
-      Gtk::Image* iconDev{new Gtk::Image{}};
-      iconDev->set_from_icon_name(iconNameDev, Gtk::ICON_SIZE_INVALID);
-      iconDev->set_pixel_size(iconSize_);
-      boxDev->add(*iconDev);
-      // Set label from model
-      Gtk::Label* labelDev{new Gtk::Label{pairDev.second.model}};
-      boxDev->add(*labelDev);
-      // Construct user box
-      // Set icon from icon state
-      if (pairDev.second.icon_name == NULL || !gtkTheme_->has_icon(pairDev.second.icon_name))
-        pairDev.second.icon_name = (char*)NO_BATTERY.c_str();
-      Gtk::Image* iconTooltip{new Gtk::Image{}};
-      iconTooltip->set_from_icon_name(pairDev.second.icon_name, Gtk::ICON_SIZE_INVALID);
-      iconTooltip->set_pixel_size(iconSize_);
-      boxUsr->add(*iconTooltip);
-      // Set markup text
-      Gtk::Label* labelTooltip{new Gtk::Label{}};
-      labelTooltip->set_markup(getText(pairDev.second, tooltipFormat_));
-      boxUsr->add(*labelTooltip);
-    }
-  }
-  tooltip->set_custom(contentBox_);
-  contentBox_.show_all();
+  // Rows are updated when devices change, the query only shows them
+  tooltip->set_custom(tooltip_->root());
 
   return true;
 }
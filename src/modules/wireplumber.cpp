@@ -4,17 +4,9 @@
 
 bool isValidNodeId(uint32_t id) { return id > 0 && id < G_MAXUINT32; }
 
-std::list<waybar::modules::Wireplumber*> waybar::modules::Wireplumber::modules;
-
 waybar::modules::Wireplumber::Wireplumber(const std::string& id, const Json::Value& config)
     : ALabel(config, "wireplumber", id, "{volume}%"),
-      wp_core_(nullptr),
-      apis_(nullptr),
-      om_(nullptr),
-      mixer_api_(nullptr),
-      def_nodes_api_(nullptr),
       default_node_name_(nullptr),
-      pending_plugins_(0),
       muted_(false),
       volume_(0.0),
       min_step_(0.0),
@@ -26,49 +18,25 @@ waybar::modules::Wireplumber::Wireplumber(const std::string& id, const Json::Val
       source_muted_(false),
       source_volume_(0.0),
       default_source_name_(nullptr) {
-  waybar::modules::Wireplumber::modules.push_back(this);
-
-  wp_init(WP_INIT_PIPEWIRE);
-  wp_core_ = wp_core_new(nullptr, nullptr, nullptr);
-  apis_ = g_ptr_array_new_with_free_func(g_object_unref);
-  om_ = wp_object_manager_new();
-
   type_ = g_strdup(config_["node-type"].isString() ? config_["node-type"].asString().c_str()
                                                    : "Audio/Sink");
 
-  prepare(this);
-
-  spdlog::debug("[{}]: connecting to pipewire: '{}'...", name_, type_);
+  spdlog::debug("[{}]: using shared pipewire connection for '{}'", name_, type_);
+  context_ = util::WireplumberContext::getInstance();
 
-  if (wp_core_connect(wp_core_) == 0) {
-    spdlog::error("[{}]: Could not connect to PipeWire: '{}'", name_, type_);
-    throw std::runtime_error("Could not connect to PipeWire\n");
+  if (context_->ready()) {
+    onContextReady();
+  } else {
+    ready_connection_ =
+        context_->signalReady().connect(sigc::mem_fun(*this, &Wireplumber::onContextReady));
   }
-
-  spdlog::debug("[{}]: {} connected!", name_, type_);
-
-  g_signal_connect_swapped(om_, "installed", (GCallback)onObjectManagerInstalled, this);
-
-  asyncLoadRequiredApiModules();
 }
 
 waybar::modules::Wireplumber::~Wireplumber() {
-  waybar::modules::Wireplumber::modules.remove(this);
-  if (mixer_api_ != nullptr) {
-    g_signal_handlers_disconnect_by_data(mixer_api_, this);
-  }
-  if (def_nodes_api_ != nullptr) {
-    g_signal_handlers_disconnect_by_data(def_nodes_api_, this);
-  }
-  if (om_ != nullptr) {
-    g_signal_handlers_disconnect_by_data(om_, this);
-  }
-  wp_core_disconnect(wp_core_);
-  g_clear_pointer(&apis_, g_ptr_array_unref);
-  g_clear_object(&om_);
-  g_clear_object(&wp_core_);
-  g_clear_object(&mixer_api_);
-  g_clear_object(&def_nodes_api_);
+  ready_connection_.disconnect();
+  default_nodes_connection_.disconnect();
+  node_connection_.disconnect();
+  source_node_connection_.disconnect();
   g_free(default_node_name_);
   g_free(default_source_name_);
   g_free(type_);
@@ -83,9 +51,9 @@ void waybar::modules::Wireplumber::updateNodeName(waybar::modules::Wireplumber*
     return;
   }
 
-  auto* proxy = static_cast<WpProxy*>(wp_object_manager_lookup(self->om_, WP_TYPE_GLOBAL_PROXY,
-                                                               WP_CONSTRAINT_TYPE_G_PROPERTY,
-                                                               "bound-id", "=u", id, nullptr));
+  auto* proxy = static_cast<WpProxy*>(
+      wp_object_manager_lookup(self->context_->objectManager(), WP_TYPE_GLOBAL_PROXY,
+                               WP_CONSTRAINT_TYPE_G_PROPERTY, "bound-id", "=u", id, nullptr));
 
   if (proxy == nullptr) {
     auto err = fmt::format("Object '{}' not found\n", id);
@@ -120,9 +88,9 @@ void waybar::modules::Wireplumber::updateSourceName(waybar::modules::Wireplumber
     return;
   }
 
-  auto* proxy = static_cast<WpProxy*>(wp_object_manager_lookup(self->om_, WP_TYPE_GLOBAL_PROXY,
-                                                               WP_CONSTRAINT_TYPE_G_PROPERTY,
-                                                               "bound-id", "=u", id, nullptr));
+  auto* proxy = static_cast<WpProxy*>(
+      wp_object_manager_lookup(self->context_->objectManager(), WP_TYPE_GLOBAL_PROXY,
+                               WP_CONSTRAINT_TYPE_G_PROPERTY, "bound-id", "=u", id, nullptr));
 
   if (proxy == nullptr) {
     auto err = fmt::format("Source object '{}' not found\n", id);
@@ -157,7 +125,7 @@ void waybar::modules::Wireplumber::updateVolume(waybar::modules::Wireplumber* se
     return;
   }
 
-  g_signal_emit_by_name(self->mixer_api_, "get-volume", id, &variant);
+  g_signal_emit_by_name(self->context_->mixerApi(), "get-volume", id, &variant);
 
   if (variant == nullptr) {
     auto err = fmt::format("Node {} does not support volume\n", id);
@@ -184,7 +152,7 @@ void waybar::modules::Wireplumber::updateSourceVolume(waybar::modules::Wireplumb
     return;
   }
 
-  g_signal_emit_by_name(self->mixer_api_, "get-volume", id, &variant);
+  g_signal_emit_by_name(self->context_->mixerApi(), "get-volume", id, &variant);
 
   if (variant == nullptr) {
     spdlog::debug("[{}]: Source node {} does not support volume", self->name_, id);
@@ -199,20 +167,12 @@ void waybar::modules::Wireplumber::updateSourceVolume(waybar::modules::Wireplumb
 }
 
 void waybar::modules::Wireplumber::onMixerChanged(waybar::modules::Wireplumber* self, uint32_t id) {
-  g_autoptr(WpNode) node = static_cast<WpNode*>(wp_object_manager_lookup(
-      self->om_, WP_TYPE_NODE, WP_CONSTRAINT_TYPE_G_PROPERTY, "bound-id", "=u", id, nullptr));
+  // Only called for the nodes this module subscribed to
+  g_autoptr(WpNode) node = static_cast<WpNode*>(
+      wp_object_manager_lookup(self->context_->objectManager(), WP_TYPE_NODE,
+                               WP_CONSTRAINT_TYPE_G_PROPERTY, "bound-id", "=u", id, nullptr));
 
   if (node == nullptr) {
-    // log a warning only if no other widget is targeting the id.
-    // this reduces log spam when multiple instances of the module are used on different node types.
-    if (id != self->node_id_ && id != self->source_node_id_) {
-      for (auto const& module : waybar::modules::Wireplumber::modules) {
-        if (module->node_id_ == id || module->source_node_id_ == id) {
-          return;
-        }
-      }
-    }
-
     spdlog::warn("[{}]: (onMixerChanged: {}) - Object with id {} not found", self->name_,
                  self->type_, id);
     return;
@@ -236,12 +196,14 @@ void waybar::modules::Wireplumber::onDefaultNodesApiChanged(waybar::modules::Wir
 
   // Handle sink
   uint32_t defaultNodeId;
-  g_signal_emit_by_name(self->def_nodes_api_, "get-default-node", self->type_, &defaultNodeId);
+  g_signal_emit_by_name(self->context_->defaultNodesApi(), "get-default-node", self->type_,
+                        &defaultNodeId);
 
   if (isValidNodeId(defaultNodeId)) {
     g_autoptr(WpNode) node = static_cast<WpNode*>(
-        wp_object_manager_lookup(self->om_, WP_TYPE_NODE, WP_CONSTRAINT_TYPE_G_PROPERTY, "bound-id",
-                                 "=u", defaultNodeId, nullptr));
+        wp_object_manager_lookup(self->context_->objectManager(), WP_TYPE_NODE,
+                                 WP_CONSTRAINT_TYPE_G_PROPERTY, "bound-id", "=u", defaultNodeId,
+                                 nullptr));
 
     if (node != nullptr) {
       const gchar* defaultNodeName =
@@ -257,18 +219,21 @@ void waybar::modules::Wireplumber::onDefaultNodesApiChanged(waybar::modules::Wir
         self->node_id_ = defaultNodeId;
         updateVolume(self, defaultNodeId);
         updateNodeName(self, defaultNodeId);
+        self->subscribeNodes();
       }
     }
   }
 
   // Handle source
   uint32_t defaultSourceId;
-  g_signal_emit_by_name(self->def_nodes_api_, "get-default-node", "Audio/Source", &defaultSourceId);
+  g_signal_emit_by_name(self->context_->defaultNodesApi(), "get-default-node", "Audio/Source",
+                        &defaultSourceId);
 
   if (isValidNodeId(defaultSourceId)) {
     g_autoptr(WpNode) sourceNode = static_cast<WpNode*>(
-        wp_object_manager_lookup(self->om_, WP_TYPE_NODE, WP_CONSTRAINT_TYPE_G_PROPERTY, "bound-id",
-                                 "=u", defaultSourceId, nullptr));
+        wp_object_manager_lookup(self->context_->objectManager(), WP_TYPE_NODE,
+                                 WP_CONSTRAINT_TYPE_G_PROPERTY, "bound-id", "=u", defaultSourceId,
+                                 nullptr));
 
     if (sourceNode != nullptr) {
       const gchar* defaultSourceName =
@@ -284,146 +249,62 @@ void waybar::modules::Wireplumber::onDefaultNodesApiChanged(waybar::modules::Wir
         self->source_node_id_ = defaultSourceId;
         updateSourceVolume(self, defaultSourceId);
         updateSourceName(self, defaultSourceId);
+        self->subscribeNodes();
       }
     }
   }
 }
 
-void waybar::modules::Wireplumber::onObjectManagerInstalled(waybar::modules::Wireplumber* self) {
-  spdlog::debug("[{}]: onObjectManagerInstalled", self->name_);
-
-  self->def_nodes_api_ = wp_plugin_find(self->wp_core_, "default-nodes-api");
-
-  if (self->def_nodes_api_ == nullptr) {
-    spdlog::error("[{}]: default nodes api is not loaded.", self->name_);
-    return;
-  }
-
-  self->mixer_api_ = wp_plugin_find(self->wp_core_, "mixer-api");
-
-  if (self->mixer_api_ == nullptr) {
-    spdlog::error("[{}]: mixer api is not loaded.", self->name_);
-    return;
-  }
+void waybar::modules::Wireplumber::onContextReady() {
+  spdlog::debug("[{}]: onContextReady", name_);
+  auto* def_nodes_api = context_->defaultNodesApi();
 
   // Get default sink
-  g_signal_emit_by_name(self->def_nodes_api_, "get-default-configured-node-name", self->type_,
-                        &self->default_node_name_);
-  g_signal_emit_by_name(self->def_nodes_api_, "get-default-node", self->type_, &self->node_id_);
+  g_signal_emit_by_name(def_nodes_api, "get-default-configured-node-name", type_,
+                        &default_node_name_);
+  g_signal_emit_by_name(def_nodes_api, "get-default-node", type_, &node_id_);
 
   // Get default source
-  g_signal_emit_by_name(self->def_nodes_api_, "get-default-configured-node-name", "Audio/Source",
-                        &self->default_source_name_);
-  g_signal_emit_by_name(self->def_nodes_api_, "get-default-node", "Audio/Source",
-                        &self->source_node_id_);
-
-  if (self->default_node_name_ != nullptr) {
-    spdlog::debug(
-        "[{}]: (onObjectManagerInstalled: {}) - default configured node name: {} and id: {}",
-        self->name_, self->type_, self->default_node_name_, self->node_id_);
-  }
-  if (self->default_source_name_ != nullptr) {
-    spdlog::debug("[{}]: default source: {} (id: {})", self->name_, self->default_source_name_,
-                  self->source_node_id_);
-  }
-
-  updateVolume(self, self->node_id_);
-  updateNodeName(self, self->node_id_);
-  updateSourceVolume(self, self->source_node_id_);
-  updateSourceName(self, self->source_node_id_);
+  g_signal_emit_by_name(def_nodes_api, "get-default-configured-node-name", "Audio/Source",
+                        &default_source_name_);
+  g_signal_emit_by_name(def_nodes_api, "get-default-node", "Audio/Source", &source_node_id_);
 
-  g_signal_connect_swapped(self->mixer_api_, "changed", (GCallback)onMixerChanged, self);
-  g_signal_connect_swapped(self->def_nodes_api_, "changed", (GCallback)onDefaultNodesApiChanged,
-                           self);
-}
-
-void waybar::modules::Wireplumber::onPluginActivated(WpObject* p, GAsyncResult* res,
-                                                     waybar::modules::Wireplumber* self) {
-  const auto* pluginName = wp_plugin_get_name(WP_PLUGIN(p));
-  spdlog::debug("[{}]: onPluginActivated: {}", self->name_, pluginName);
-  g_autoptr(GError) error = nullptr;
-
-  if (wp_object_activate_finish(p, res, &error) == 0) {
-    spdlog::error("[{}]: error activating plugin: {}", self->name_, error->message);
-    return;
+  if (default_node_name_ != nullptr) {
+    spdlog::debug("[{}]: (onContextReady: {}) - default configured node name: {} and id: {}",
+                  name_, type_, default_node_name_, node_id_);
   }
-
-  if (--self->pending_plugins_ == 0) {
-    wp_core_install_object_manager(self->wp_core_, self->om_);
+  if (default_source_name_ != nullptr) {
+    spdlog::debug("[{}]: default source: {} (id: {})", name_, default_source_name_,
+                  source_node_id_);
   }
-}
 
-void waybar::modules::Wireplumber::activatePlugins() {
-  spdlog::debug("[{}]: activating plugins", name_);
-  for (uint16_t i = 0; i < apis_->len; i++) {
-    WpPlugin* plugin = static_cast<WpPlugin*>(g_ptr_array_index(apis_, i));
-    pending_plugins_++;
-    wp_object_activate(WP_OBJECT(plugin), WP_PLUGIN_FEATURE_ENABLED, nullptr,
-                       (GAsyncReadyCallback)onPluginActivated, this);
-  }
-}
-
-void waybar::modules::Wireplumber::prepare(waybar::modules::Wireplumber* self) {
-  spdlog::debug("[{}]: preparing object manager: '{}'", name_, self->type_);
-  wp_object_manager_add_interest(om_, WP_TYPE_NODE, WP_CONSTRAINT_TYPE_PW_PROPERTY, "media.class",
-                                 "=s", self->type_, nullptr);
-  wp_object_manager_add_interest(om_, WP_TYPE_NODE, WP_CONSTRAINT_TYPE_PW_PROPERTY, "media.class",
-                                 "=s", "Audio/Source", nullptr);
-}
+  updateVolume(this, node_id_);
+  updateNodeName(this, node_id_);
+  updateSourceVolume(this, source_node_id_);
+  updateSourceName(this, source_node_id_);
+  subscribeNodes();
 
-void waybar::modules::Wireplumber::onDefaultNodesApiLoaded(WpObject* p, GAsyncResult* res,
-                                                           waybar::modules::Wireplumber* self) {
-  gboolean success = FALSE;
-  g_autoptr(GError) error = nullptr;
+  default_nodes_connection_ = context_->signalDefaultNodesChanged().connect(
+      [this]() { onDefaultNodesApiChanged(this); });
 
-  spdlog::debug("[{}]: callback loading default node api module", self->name_);
+  dp.emit();
 
-  success = wp_core_load_component_finish(self->wp_core_, res, &error);
-
-  if (success == FALSE) {
-    spdlog::error("[{}]: default nodes API load failed", self->name_);
-    return;
-  }
-  spdlog::debug("[{}]: loaded default nodes api", self->name_);
-  g_ptr_array_add(self->apis_, wp_plugin_find(self->wp_core_, "default-nodes-api"));
-
-  spdlog::debug("[{}]: loading mixer api module", self->name_);
-  wp_core_load_component(self->wp_core_, "libwireplumber-module-mixer-api", "module", nullptr,
-                         "mixer-api", nullptr, (GAsyncReadyCallback)onMixerApiLoaded, self);
+  event_box_.add_events(Gdk::SCROLL_MASK | Gdk::SMOOTH_SCROLL_MASK);
+  event_box_.signal_scroll_event().connect(sigc::mem_fun(*this, &Wireplumber::handleScroll));
 }
 
-void waybar::modules::Wireplumber::onMixerApiLoaded(WpObject* p, GAsyncResult* res,
-                                                    waybar::modules::Wireplumber* self) {
-  gboolean success = FALSE;
-  g_autoptr(GError) error = nullptr;
-
-  success = wp_core_load_component_finish(self->wp_core_, res, &error);
-
-  if (success == FALSE) {
-    spdlog::error("[{}]: mixer API load failed", self->name_);
-    return;
+// Mixer changes are only delivered for the nodes this module displays
+void waybar::modules::Wireplumber::subscribeNodes() {
+  node_connection_.disconnect();
+  source_node_connection_.disconnect();
+  if (isValidNodeId(node_id_)) {
+    node_connection_ =
+        context_->connectNode(node_id_, [this]() { onMixerChanged(this, node_id_); });
+  }
+  if (isValidNodeId(source_node_id_) && source_node_id_ != node_id_) {
+    source_node_connection_ = context_->connectNode(
+        source_node_id_, [this]() { onMixerChanged(this, source_node_id_); });
   }
-
-  spdlog::debug("[{}]: loaded mixer API", self->name_);
-  g_ptr_array_add(self->apis_, ({
-                    WpPlugin* p = wp_plugin_find(self->wp_core_, "mixer-api");
-                    g_object_set(G_OBJECT(p), "scale", 1 /* cubic */, nullptr);
-                    p;
-                  }));
-
-  self->activatePlugins();
-
-  self->dp.emit();
-
-  self->event_box_.add_events(Gdk::SCROLL_MASK | Gdk::SMOOTH_SCROLL_MASK);
-  self->event_box_.signal_scroll_event().connect(sigc::mem_fun(*self, &Wireplumber::handleScroll));
-}
-
-void waybar::modules::Wireplumber::asyncLoadRequiredApiModules() {
-  spdlog::debug("[{}]: loading default nodes api module", name_);
-  wp_core_load_component(wp_core_, "libwireplumber-module-default-nodes-api", "module", nullptr,
-                         "default-nodes-api", nullptr, (GAsyncReadyCallback)onDefaultNodesApiLoaded,
-                         this);
 }
 
 auto waybar::modules::Wireplumber::update() -> void {
@@ -533,10 +414,11 @@ bool waybar::modules::Wireplumber::handleScroll(GdkEventScroll* e) {
     }
   }
   if (newVol != volume_) {
-    if (mixer_api_ == nullptr) return true;
+    auto* mixer_api = context_->mixerApi();
+    if (mixer_api == nullptr) return true;
     GVariant* variant = g_variant_new_double(newVol);
     gboolean ret;
-    g_signal_emit_by_name(mixer_api_, "set-volume", node_id_, variant, &ret);
+    g_signal_emit_by_name(mixer_api, "set-volume", node_id_, variant, &ret);
     g_variant_unref(variant);
   }
   return true;
@@ -0,0 +1,260 @@
+#include "modules/wlr/foreign_toplevels.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+#include "client.hpp"
+#include "util/icon_loader.hpp"
+
+namespace waybar::modules::wlr {
+
+bool Toplevel::on_output(struct wl_output* output) const {
+  return std::find(outputs.begin(), outputs.end(), output) != outputs.end();
+}
+
+Glib::RefPtr<Gio::DesktopAppInfo> Toplevel::app_info_for_app_id(
+    const std::string& mapped_app_id) const {
+  auto it = app_infos_.find(mapped_app_id);
+  if (it == app_infos_.end()) {
+    it = app_infos_.emplace(mapped_app_id,
+                            IconLoader::get_app_info_from_app_id_list(mapped_app_id))
+             .first;
+  }
+  return it->second;
+}
+
+Glib::RefPtr<Gio::DesktopAppInfo> Toplevel::app_info_for_title() const {
+  if (!title_info_ || title_info_->first != title) {
+    title_info_.emplace(title, IconLoader::get_app_info_from_app_id_list(title));
+  }
+  return title_info_->second;
+}
+
+static void tl_handle_title(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
+                            const char* title) {
+  auto* toplevel = static_cast<Toplevel*>(data);
+  toplevel->owner->handle_title(*toplevel, title);
+}
+
+static void tl_handle_app_id(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
+                             const char* app_id) {
+  auto* toplevel = static_cast<Toplevel*>(data);
+  toplevel->owner->handle_app_id(*toplevel, app_id);
+}
+
+static void tl_handle_output_enter(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
+                                   struct wl_output* output) {
+  auto* toplevel = static_cast<Toplevel*>(data);
+  toplevel->owner->handle_output_enter(*toplevel, output);
+}
+
+static void tl_handle_output_leave(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
+                                   struct wl_output* output) {
+  auto* toplevel = static_cast<Toplevel*>(data);
+  toplevel->owner->handle_output_leave(*toplevel, output);
+}
+
+static void tl_handle_state(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
+                            struct wl_array* state) {
+  auto* toplevel = static_cast<Toplevel*>(data);
+  toplevel->owner->handle_state(*toplevel, state);
+}
+
+static void tl_handle_done(void* data, struct zwlr_foreign_toplevel_handle_v1* handle) {
+  auto* toplevel = static_cast<Toplevel*>(data);
+  toplevel->owner->handle_done(*toplevel);
+}
+
+static void tl_handle_parent(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
+                             struct zwlr_foreign_toplevel_handle_v1* parent) {
+  /* This is explicitly left blank */
+}
+
+static void tl_handle_closed(void* data, struct zwlr_foreign_toplevel_handle_v1* handle) {
+  auto* toplevel = static_cast<Toplevel*>(data);
+  toplevel->owner->handle_closed(*toplevel);
+}
+
+static const struct zwlr_foreign_toplevel_handle_v1_listener toplevel_handle_impl = {
+    .title = tl_handle_title,
+    .app_id = tl_handle_app_id,
+    .output_enter = tl_handle_output_enter,
+    .output_leave = tl_handle_output_leave,
+    .state = tl_handle_state,
+    .done = tl_handle_done,
+    .closed = tl_handle_closed,
+    .parent = tl_handle_parent,
+};
+
+static void tm_handle_toplevel(void* data, struct zwlr_foreign_toplevel_manager_v1* manager,
+                               struct zwlr_foreign_toplevel_handle_v1* tl_handle) {
+  static_cast<ForeignToplevels*>(data)->handle_toplevel_create(tl_handle);
+}
+
+static void tm_handle_finished(void* data, struct zwlr_foreign_toplevel_manager_v1* manager) {
+  static_cast<ForeignToplevels*>(data)->handle_finished();
+}
+
+static const struct zwlr_foreign_toplevel_manager_v1_listener toplevel_manager_impl = {
+    .toplevel = tm_handle_toplevel,
+    .finished = tm_handle_finished,
+};
+
+std::shared_ptr<ForeignToplevels> ForeignToplevels::getInstance() {
+  static std::weak_ptr<ForeignToplevels> instance;
+  auto toplevels = instance.lock();
+  if (!toplevels) {
+    PrivateConstructorTag tag;
+    toplevels = std::make_shared<ForeignToplevels>(tag);
+    instance = toplevels;
+  }
+  return toplevels;
+}
+
+ForeignToplevels::ForeignToplevels(PrivateConstructorTag /*tag*/) {
+  auto& globals = Client::inst()->globals;
+  auto version = globals.version(zwlr_foreign_toplevel_manager_v1_interface);
+  if (version == 0) {
+    return;
+  }
+  if (version < ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_SET_FULLSCREEN_SINCE_VERSION) {
+    spdlog::warn(
+        "Foreign toplevel manager server does not have the appropriate version."
+        " To be able to use all features, you need at least version 2, but server is version {}",
+        version);
+  }
+
+  // The version is limited to the highest supported by the client protocol file
+  manager_ = globals.bind<struct zwlr_foreign_toplevel_manager_v1>(
+      zwlr_foreign_toplevel_manager_v1_interface);
+
+  if (manager_)
+    zwlr_foreign_toplevel_manager_v1_add_listener(manager_, &toplevel_manager_impl, this);
+  else
+    spdlog::debug("Failed to register manager");
+}
+
+ForeignToplevels::~ForeignToplevels() {
+  for (auto& [id, toplevel] : toplevels_) {
+    zwlr_foreign_toplevel_handle_v1_destroy(toplevel->handle);
+  }
+  toplevels_.clear();
+
+  if (manager_) {
+    struct wl_display* display = Client::inst()->wl_display;
+    /*
+     * Send `stop` request and wait for one roundtrip.
+     * This is not quite correct as the protocol encourages us to wait for the .finished event,
+     * but it should work with wlroots foreign toplevel manager implementation.
+     */
+    zwlr_foreign_toplevel_manager_v1_stop(manager_);
+    wl_display_roundtrip(display);
+
+    if (manager_) {
+      spdlog::warn("Foreign toplevel manager destroyed before .finished event");
+      zwlr_foreign_toplevel_manager_v1_destroy(manager_);
+      manager_ = nullptr;
+    }
+  }
+}
+
+ForeignToplevels::SubscriptionId ForeignToplevels::subscribe(Subscriber subscriber) {
+  for (const auto& [id, toplevel] : toplevels_) {
+    if (toplevel->announced) {
+      subscriber(*toplevel);
+    }
+  }
+  auto id = next_subscription_++;
+  subscribers_.emplace(id, std::move(subscriber));
+  return id;
+}
+
+void ForeignToplevels::unsubscribe(SubscriptionId id) { subscribers_.erase(id); }
+
+void ForeignToplevels::notify(const Toplevel& toplevel) {
+  for (const auto& [id, subscriber] : subscribers_) {
+    subscriber(toplevel);
+  }
+}
+
+void ForeignToplevels::destroy(Toplevel& toplevel) {
+  if (toplevel.announced) {
+    toplevel.closed = true;
+    notify(toplevel);
+  }
+  zwlr_foreign_toplevel_handle_v1_destroy(toplevel.handle);
+  auto id = toplevel.id;
+  toplevels_.erase(id);
+}
+
+void ForeignToplevels::handle_toplevel_create(struct zwlr_foreign_toplevel_handle_v1* handle) {
+  auto id = next_id_++;
+  auto& toplevel = *toplevels_.emplace(id, std::make_unique<Toplevel>()).first->second;
+  toplevel.id = id;
+  toplevel.handle = handle;
+  toplevel.owner = this;
+  // Events go straight to their toplevel, no lookup by handle
+  zwlr_foreign_toplevel_handle_v1_add_listener(handle, &toplevel_handle_impl, &toplevel);
+}
+
+void ForeignToplevels::handle_finished() {
+  // The compositor closes the toplevels before, this only drops what it left over
+  while (!toplevels_.empty()) {
+    destroy(*toplevels_.begin()->second);
+  }
+  zwlr_foreign_toplevel_manager_v1_destroy(manager_);
+  manager_ = nullptr;
+}
+
+void ForeignToplevels::handle_title(Toplevel& toplevel, const char* title) {
+  toplevel.title = title;
+}
+
+void ForeignToplevels::handle_app_id(Toplevel& toplevel, const char* app_id) {
+  if (toplevel.app_id != app_id) {
+    toplevel.app_id = app_id;
+    toplevel.app_infos_.clear();
+  }
+}
+
+void ForeignToplevels::handle_output_enter(Toplevel& toplevel, struct wl_output* output) {
+  if (!toplevel.on_output(output)) {
+    toplevel.outputs.push_back(output);
+  }
+}
+
+void ForeignToplevels::handle_output_leave(Toplevel& toplevel, struct wl_output* output) {
+  std::erase(toplevel.outputs, output);
+}
+
+void ForeignToplevels::handle_state(Toplevel& toplevel, struct wl_array* state) {
+  toplevel.state = 0;
+  size_t size = state->size / sizeof(uint32_t);
+  for (size_t i = 0; i < size; ++i) {
+    auto entry = static_cast<uint32_t*>(state->data)[i];
+    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MAXIMIZED)
+      toplevel.state |= Toplevel::MAXIMIZED;
+    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MINIMIZED)
+      toplevel.state |= Toplevel::MINIMIZED;
+    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED)
+      toplevel.state |= Toplevel::ACTIVE;
+    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_FULLSCREEN)
+      toplevel.state |= Toplevel::FULLSCREEN;
+  }
+}
+
+void ForeignToplevels::handle_done(Toplevel& toplevel) {
+  if (toplevel.app_id.empty()) {
+    toplevel.app_id = "unknown";
+  }
+  toplevel.announced = true;
+  notify(toplevel);
+}
+
+void ForeignToplevels::handle_closed(Toplevel& toplevel) {
+  spdlog::debug("Toplevel ({}) closed", toplevel.id);
+  destroy(toplevel);
+}
+
+}  // namespace waybar::modules::wlr
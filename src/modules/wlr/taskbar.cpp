@@ -27,71 +27,18 @@
 namespace waybar::modules::wlr {
 
 /* Task class implementation */
-uint32_t Task::global_id = 0;
-
-static void tl_handle_title(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
-                            const char* title) {
-  return static_cast<Task*>(data)->handle_title(title);
-}
-
-static void tl_handle_app_id(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
-                             const char* app_id) {
-  return static_cast<Task*>(data)->handle_app_id(app_id);
-}
-
-static void tl_handle_output_enter(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
-                                   struct wl_output* output) {
-  return static_cast<Task*>(data)->handle_output_enter(output);
-}
-
-static void tl_handle_output_leave(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
-                                   struct wl_output* output) {
-  return static_cast<Task*>(data)->handle_output_leave(output);
-}
-
-static void tl_handle_state(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
-                            struct wl_array* state) {
-  return static_cast<Task*>(data)->handle_state(state);
-}
-
-static void tl_handle_done(void* data, struct zwlr_foreign_toplevel_handle_v1* handle) {
-  return static_cast<Task*>(data)->handle_done();
-}
-
-static void tl_handle_parent(void* data, struct zwlr_foreign_toplevel_handle_v1* handle,
-                             struct zwlr_foreign_toplevel_handle_v1* parent) {
-  /* This is explicitly left blank */
-}
-
-static void tl_handle_closed(void* data, struct zwlr_foreign_toplevel_handle_v1* handle) {
-  return static_cast<Task*>(data)->handle_closed();
-}
-
-static const struct zwlr_foreign_toplevel_handle_v1_listener toplevel_handle_impl = {
-    .title = tl_handle_title,
-    .app_id = tl_handle_app_id,
-    .output_enter = tl_handle_output_enter,
-    .output_leave = tl_handle_output_leave,
-    .state = tl_handle_state,
-    .done = tl_handle_done,
-    .closed = tl_handle_closed,
-    .parent = tl_handle_parent,
-};
-
 static const std::vector<Gtk::TargetEntry> target_entries = {
     Gtk::TargetEntry("WAYBAR_TOPLEVEL", Gtk::TARGET_SAME_APP, 0)};
 
 Task::Task(const waybar::Bar& bar, const Json::Value& config, Taskbar* tbar,
-           struct zwlr_foreign_toplevel_handle_v1* tl_handle, struct wl_seat* seat)
+           const Toplevel& toplevel, struct wl_seat* seat)
     : bar_{bar},
       config_{config},
       tbar_{tbar},
-      handle_{tl_handle},
+      handle_{toplevel.handle},
       seat_{seat},
-      id_{global_id++},
+      id_{toplevel.id},
       content_{bar.orientation, 0} {
-  zwlr_foreign_toplevel_handle_v1_add_listener(handle_, &toplevel_handle_impl, this);
-
   button.set_relief(Gtk::RELIEF_NONE);
 
   content_.add(text_before_);
@@ -122,10 +69,6 @@ Task::Task(const waybar::Bar& bar, const Json::Value& config, Taskbar* tbar,
     with_icon_ = true;
   }
 
-  if (app_id_.empty()) {
-    handle_app_id("unknown");
-  }
-
   /* Strip spaces at the beginning and end of the format strings */
   format_tooltip_.clear();
   if (!config_["tooltip"].isBool() || config_["tooltip"].asBool()) {
@@ -152,17 +95,18 @@ Task::Task(const waybar::Bar& bar, const Json::Value& config, Taskbar* tbar,
   button.signal_drag_data_get().connect(sigc::mem_fun(*this, &Task::handle_drag_data_get), false);
   button.signal_drag_data_received().connect(sigc::mem_fun(*this, &Task::handle_drag_data_received),
                                              false);
+  button.signal_size_allocate().connect_notify(
+      sigc::mem_fun(this, &Task::on_button_size_allocated));
+
+  handle_changed(toplevel);
+  tbar_->add_button(button);
+  button.show();
+  spdlog::debug("{} now visible on {}", repr(), bar_.output->name);
 }
 
 Task::~Task() {
-  if (handle_) {
-    zwlr_foreign_toplevel_handle_v1_destroy(handle_);
-    handle_ = nullptr;
-  }
-  if (button_visible_) {
-    tbar_->remove_button(button);
-    button_visible_ = false;
-  }
+  /* The handle belongs to the shared toplevel */
+  tbar_->remove_button(button);
 }
 
 std::string Task::repr() const {
@@ -189,20 +133,23 @@ std::string Task::state_string(bool shortened) const {
     return res.substr(0, res.size() - 1);
 }
 
-void Task::handle_title(const char* title) {
+void Task::set_title(const Toplevel& toplevel) {
+  const auto& title = toplevel.title;
+  if (title == title_) {
+    return;
+  }
   if (title_.empty()) {
-    spdlog::debug(fmt::format("Task ({}) setting title to {}", id_, title_));
+    spdlog::debug(fmt::format("Task ({}) setting title to {}", id_, title));
   } else {
     spdlog::debug(fmt::format("Task ({}) overwriting title '{}' with '{}'", id_, title_, title));
   }
   title_ = title;
-  hide_if_ignored();
 
   if ((!with_icon_ && !with_name_) || app_info_) {
     return;
   }
 
-  app_info_ = IconLoader::get_app_info_from_app_id_list(title_);
+  app_info_ = toplevel.app_info_for_title();
   name_ = app_info_ ? app_info_->get_display_name() : title;
 
   if (!with_icon_) {
@@ -221,45 +168,33 @@ void Task::set_minimize_hint() {
                                                 minimize_hint.y, minimize_hint.w, minimize_hint.h);
 }
 
-void Task::hide_if_ignored() {
-  if (tbar_->ignore_list().count(app_id_) || tbar_->ignore_list().count(title_)) {
-    ignored_ = true;
-    if (button_visible_) {
-      auto output = gdk_wayland_monitor_get_wl_output(bar_.output->monitor->gobj());
-      handle_output_leave(output);
-    }
-  } else {
-    bool is_was_ignored = ignored_;
-    ignored_ = false;
-    if (is_was_ignored) {
-      auto output = gdk_wayland_monitor_get_wl_output(bar_.output->monitor->gobj());
-      handle_output_enter(output);
-    }
+void Task::set_app_id(const Toplevel& toplevel) {
+  const auto& app_id = toplevel.app_id;
+  if (app_id == raw_app_id_) {
+    return;
   }
-}
-
-void Task::handle_app_id(const char* app_id) {
-  if (app_id_.empty()) {
+  if (raw_app_id_.empty()) {
     spdlog::debug(fmt::format("Task ({}) setting app_id to {}", id_, app_id));
   } else {
-    spdlog::debug(fmt::format("Task ({}) overwriting app_id '{}' with '{}'", id_, app_id_, app_id));
+    spdlog::debug(
+        fmt::format("Task ({}) overwriting app_id '{}' with '{}'", id_, raw_app_id_, app_id));
   }
+  raw_app_id_ = app_id;
   app_id_ = app_id;
-  hide_if_ignored();
 
-  auto ids_replace_map = tbar_->app_ids_replace_map();
-  if (ids_replace_map.count(app_id_)) {
-    auto replaced_id = ids_replace_map[app_id_];
+  const auto& ids_replace_map = tbar_->app_ids_replace_map();
+  if (auto it = ids_replace_map.find(app_id_); it != ids_replace_map.end()) {
     spdlog::debug(
-        fmt::format("Task ({}) [{}] app_id was replaced with {}", id_, app_id_, replaced_id));
-    app_id_ = replaced_id;
+        fmt::format("Task ({}) [{}] app_id was replaced with {}", id_, app_id_, it->second));
+    app_id_ = it->second;
   }
 
   if (!with_icon_ && !with_name_) {
     return;
   }
 
-  app_info_ = IconLoader::get_app_info_from_app_id_list(app_id_);
+  // Resolved once per toplevel, only the icon size is up to this taskbar
+  app_info_ = toplevel.app_info_for_app_id(app_id_);
   name_ = app_info_ ? app_info_->get_display_name() : app_id;
 
   if (!with_icon_) {
@@ -280,91 +215,35 @@ void Task::on_button_size_allocated(Gtk::Allocation& alloc) {
   minimize_hint.h = button.get_height();
 }
 
-void Task::handle_output_enter(struct wl_output* output) {
-  if (ignored_) {
-    spdlog::debug("{} is ignored", repr());
-    return;
-  }
-
-  spdlog::debug("{} entered output {}", repr(), (void*)output);
-
-  if (!button_visible_ && (tbar_->all_outputs() || tbar_->show_output(output))) {
-    /* The task entered the output of the current bar make the button visible */
-    button.signal_size_allocate().connect_notify(
-        sigc::mem_fun(this, &Task::on_button_size_allocated));
-    tbar_->add_button(button);
-    button.show();
-    button_visible_ = true;
-    spdlog::debug("{} now visible on {}", repr(), bar_.output->name);
-  }
-}
-
-void Task::handle_output_leave(struct wl_output* output) {
-  spdlog::debug("{} left output {}", repr(), (void*)output);
-
-  if (button_visible_ && !tbar_->all_outputs() && tbar_->show_output(output)) {
-    /* The task left the output of the current bar, make the button invisible */
-    tbar_->remove_button(button);
-    button.hide();
-    button_visible_ = false;
-    spdlog::debug("{} now invisible on {}", repr(), bar_.output->name);
-  }
-}
-
-void Task::handle_state(struct wl_array* state) {
-  state_ = 0;
-  size_t size = state->size / sizeof(uint32_t);
-  for (size_t i = 0; i < size; ++i) {
-    auto entry = static_cast<uint32_t*>(state->data)[i];
-    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MAXIMIZED) state_ |= MAXIMIZED;
-    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MINIMIZED) state_ |= MINIMIZED;
-    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED) state_ |= ACTIVE;
-    if (entry == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_FULLSCREEN) state_ |= FULLSCREEN;
-  }
-}
-
-void Task::handle_done() {
+void Task::handle_changed(const Toplevel& toplevel) {
+  set_app_id(toplevel);
+  set_title(toplevel);
+  state_ = toplevel.state;
   spdlog::debug("{} changed", repr());
 
-  if (state_ & MAXIMIZED) {
+  if (maximized()) {
     button.get_style_context()->add_class("maximized");
-  } else if (!(state_ & MAXIMIZED)) {
+  } else {
     button.get_style_context()->remove_class("maximized");
   }
 
-  if (state_ & MINIMIZED) {
+  if (minimized()) {
     button.get_style_context()->add_class("minimized");
-  } else if (!(state_ & MINIMIZED)) {
+  } else {
     button.get_style_context()->remove_class("minimized");
   }
 
-  if (state_ & ACTIVE) {
+  if (active()) {
     button.get_style_context()->add_class("active");
-  } else if (!(state_ & ACTIVE)) {
+  } else {
     button.get_style_context()->remove_class("active");
   }
 
-  if (state_ & FULLSCREEN) {
+  if (fullscreen()) {
     button.get_style_context()->add_class("fullscreen");
-  } else if (!(state_ & FULLSCREEN)) {
+  } else {
     button.get_style_context()->remove_class("fullscreen");
   }
-
-  if (config_["active-first"].isBool() && config_["active-first"].asBool() && active())
-    tbar_->move_button(button, 0);
-
-  tbar_->dp.emit();
-}
-
-void Task::handle_closed() {
-  spdlog::debug("{} closed", repr());
-  zwlr_foreign_toplevel_handle_v1_destroy(handle_);
-  handle_ = nullptr;
-  if (button_visible_) {
-    tbar_->remove_button(button);
-    button_visible_ = false;
-  }
-  tbar_->remove_task(id_);
 }
 
 bool Task::handle_clicked(GdkEventButton* bt) {
@@ -547,28 +426,10 @@ void Task::fullscreen(bool set) {
 void Task::close() { zwlr_foreign_toplevel_handle_v1_close(handle_); }
 
 /* Taskbar class implementation */
-static void handle_global(void* data, struct wl_registry* registry, uint32_t name,
-                          const char* interface, uint32_t version) {
-  if (std::strcmp(interface, zwlr_foreign_toplevel_manager_v1_interface.name) == 0) {
-    static_cast<Taskbar*>(data)->register_manager(registry, name, version);
-  } else if (std::strcmp(interface, wl_seat_interface.name) == 0) {
-    static_cast<Taskbar*>(data)->register_seat(registry, name, version);
-  }
-}
-
-static void handle_global_remove(void* data, struct wl_registry* registry, uint32_t name) {
-  /* Nothing to do here */
-}
-
-static const wl_registry_listener registry_listener_impl = {.global = handle_global,
-                                                            .global_remove = handle_global_remove};
-
 Taskbar::Taskbar(const std::string& id, const waybar::Bar& bar, const Json::Value& config)
     : waybar::AModule(config, "taskbar", id, false, false),
       bar_(bar),
-      box_{bar.orientation, 0},
-      manager_{nullptr},
-      seat_{nullptr} {
+      box_{bar.orientation, 0} {
   box_.set_name("taskbar");
   if (!id.empty()) {
     box_.get_style_context()->add_class(id);
@@ -577,13 +438,10 @@ Taskbar::Taskbar(const std::string& id, const waybar::Bar& bar, const Json::Valu
   box_.get_style_context()->add_class("empty");
   event_box_.add(box_);
 
-  struct wl_display* display = Client::inst()->wl_display;
-  struct wl_registry* registry = wl_display_get_registry(display);
-
-  wl_registry_add_listener(registry, &registry_listener_impl, this);
-  wl_display_roundtrip(display);
+  auto toplevels = ForeignToplevels::getInstance();
+  seat_ = Client::inst()->globals.acquire(wl_seat_interface, 1, &wl_seat_destroy);
 
-  if (!manager_) {
+  if (!toplevels->available()) {
     spdlog::error("Failed to register as toplevel manager");
     return;
   }
@@ -617,27 +475,14 @@ Taskbar::Taskbar(const std::string& id, const waybar::Bar& bar, const Json::Valu
     }
   }
 
-  for (auto& t : tasks_) {
-    t->handle_app_id(t->app_id().c_str());
-  }
+  toplevels_ = std::move(toplevels);
+  subscription_ =
+      toplevels_->subscribe([this](const Toplevel& toplevel) { handle_toplevel(toplevel); });
 }
 
 Taskbar::~Taskbar() {
-  if (manager_) {
-    struct wl_display* display = Client::inst()->wl_display;
-    /*
-     * Send `stop` request and wait for one roundtrip.
-     * This is not quite correct as the protocol encourages us to wait for the .finished event,
-     * but it should work with wlroots foreign toplevel manager implementation.
-     */
-    zwlr_foreign_toplevel_manager_v1_stop(manager_);
-    wl_display_roundtrip(display);
-
-    if (manager_) {
-      spdlog::warn("Foreign toplevel manager destroyed before .finished event");
-      zwlr_foreign_toplevel_manager_v1_destroy(manager_);
-      manager_ = nullptr;
-    }
+  if (toplevels_) {
+    toplevels_->unsubscribe(subscription_);
   }
 }
 
@@ -660,61 +505,48 @@ void Taskbar::update() {
   AModule::update();
 }
 
-static void tm_handle_toplevel(void* data, struct zwlr_foreign_toplevel_manager_v1* manager,
-                               struct zwlr_foreign_toplevel_handle_v1* tl_handle) {
-  return static_cast<Taskbar*>(data)->handle_toplevel_create(tl_handle);
-}
-
-static void tm_handle_finished(void* data, struct zwlr_foreign_toplevel_manager_v1* manager) {
-  return static_cast<Taskbar*>(data)->handle_finished();
-}
-
-static const struct zwlr_foreign_toplevel_manager_v1_listener toplevel_manager_impl = {
-    .toplevel = tm_handle_toplevel,
-    .finished = tm_handle_finished,
-};
-
-void Taskbar::register_manager(struct wl_registry* registry, uint32_t name, uint32_t version) {
-  if (manager_) {
-    spdlog::warn("Register foreign toplevel manager again although already existing!");
-    return;
+bool Taskbar::shows(const Toplevel& toplevel, bool shown) const {
+  if (toplevel.closed || ignore_list_.contains(toplevel.app_id) ||
+      ignore_list_.contains(toplevel.title)) {
+    return false;
   }
-  if (version < ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_SET_FULLSCREEN_SINCE_VERSION) {
-    spdlog::warn(
-        "Foreign toplevel manager server does not have the appropriate version."
-        " To be able to use all features, you need at least version 2, but server is version {}",
-        version);
+  if (auto it = app_ids_replace_map_.find(toplevel.app_id);
+      it != app_ids_replace_map_.end() && ignore_list_.contains(it->second)) {
+    return false;
   }
-
-  // limit version to a highest supported by the client protocol file
-  version = std::min<uint32_t>(version, zwlr_foreign_toplevel_manager_v1_interface.version);
-
-  manager_ = static_cast<struct zwlr_foreign_toplevel_manager_v1*>(
-      wl_registry_bind(registry, name, &zwlr_foreign_toplevel_manager_v1_interface, version));
-
-  if (manager_)
-    zwlr_foreign_toplevel_manager_v1_add_listener(manager_, &toplevel_manager_impl, this);
-  else
-    spdlog::debug("Failed to register manager");
+  if (all_outputs()) {
+    // Once shown, the task stays even when it leaves every output
+    return shown || !toplevel.outputs.empty();
+  }
+  return std::any_of(toplevel.outputs.begin(), toplevel.outputs.end(),
+                     [this](auto* output) { return show_output(output); });
 }
 
-void Taskbar::register_seat(struct wl_registry* registry, uint32_t name, uint32_t version) {
-  if (seat_) {
-    spdlog::warn("Register seat again although already existing!");
+void Taskbar::handle_toplevel(const Toplevel& toplevel) {
+  auto it = std::find_if(tasks_.begin(), tasks_.end(),
+                         [&toplevel](const TaskPtr& p) { return p->id() == toplevel.id; });
+  bool shown = it != tasks_.end();
+  if (!shows(toplevel, shown)) {
+    if (shown) {
+      spdlog::debug("Task ({}) now invisible on {}", toplevel.id, bar_.output->name);
+      tasks_.erase(it);
+      dp.emit();
+    }
     return;
   }
-  version = std::min<uint32_t>(version, wl_seat_interface.version);
 
-  seat_ = static_cast<wl_seat*>(wl_registry_bind(registry, name, &wl_seat_interface, version));
-}
+  // Widgets only exist for the tasks of this bar
+  if (shown) {
+    (*it)->handle_changed(toplevel);
+  } else {
+    it = tasks_.insert(tasks_.end(),
+                       std::make_unique<Task>(bar_, config_, this, toplevel, seat_.get()));
+  }
 
-void Taskbar::handle_toplevel_create(struct zwlr_foreign_toplevel_handle_v1* tl_handle) {
-  tasks_.push_back(std::make_unique<Task>(bar_, config_, this, tl_handle, seat_));
-}
+  if (config_["active-first"].isBool() && config_["active-first"].asBool() && (*it)->active())
+    move_button((*it)->button, 0);
 
-void Taskbar::handle_finished() {
-  zwlr_foreign_toplevel_manager_v1_destroy(manager_);
-  manager_ = nullptr;
+  dp.emit();
 }
 
 void Taskbar::add_button(Gtk::Button& bt) {
@@ -731,18 +563,6 @@ void Taskbar::remove_button(Gtk::Button& bt) {
   }
 }
 
-void Taskbar::remove_task(uint32_t id) {
-  auto it = std::find_if(std::begin(tasks_), std::end(tasks_),
-                         [id](const TaskPtr& p) { return p->id() == id; });
-
-  if (it == std::end(tasks_)) {
-    spdlog::warn("Can't find task with id {}", id);
-    return;
-  }
-
-  tasks_.erase(it);
-}
-
 bool Taskbar::show_output(struct wl_output* output) const {
   return output == gdk_wayland_monitor_get_wl_output(bar_.output->monitor->gobj());
 }
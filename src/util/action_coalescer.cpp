@@ -0,0 +1,38 @@
+#include "util/action_coalescer.hpp"
+
+#include <glibmm/main.h>
+
+#include <utility>
+
+namespace waybar::util {
+
+ActionCoalescer::ActionCoalescer(std::chrono::milliseconds window, std::function<void()> action)
+    : window_(window), action_(std::move(action)) {}
+
+ActionCoalescer::~ActionCoalescer() { timer_.disconnect(); }
+
+void ActionCoalescer::trigger() {
+  if (window_.count() <= 0) {
+    action_();
+    return;
+  }
+  if (pending()) {
+    return;
+  }
+  timer_ = Glib::signal_timeout().connect(
+      [this] {
+        action_();
+        return false;
+      },
+      window_.count());
+}
+
+void ActionCoalescer::flush() {
+  if (!pending()) {
+    return;
+  }
+  timer_.disconnect();
+  action_();
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,86 @@
+#include "util/argb_pixmap.hpp"
+
+#include <cstring>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace waybar::util {
+
+void argbToRgba(const uint8_t* src, uint8_t* dst, size_t size) {
+  size_t i = 0;
+#if defined(__SSSE3__)
+  const __m128i mask = _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+  for (; i + 16 <= size; i += 16) {
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(pixels, mask));
+  }
+#elif defined(__SSE2__)
+  // Each little-endian 32-bit lane holds B G R A from high to low byte; rotating right by 8 bits
+  // moves A to the top and R to the bottom, which is R G B A in memory.
+  for (; i + 16 <= size; i += 16) {
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    pixels = _mm_or_si128(_mm_srli_epi32(pixels, 8), _mm_slli_epi32(pixels, 24));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), pixels);
+  }
+#elif defined(__ARM_NEON)
+  for (; i + 64 <= size; i += 64) {
+    uint8x16x4_t argb = vld4q_u8(src + i);
+    uint8x16x4_t rgba = {{argb.val[1], argb.val[2], argb.val[3], argb.val[0]}};
+    vst4q_u8(dst + i, rgba);
+  }
+#endif
+  for (; i + 4 <= size; i += 4) {
+    uint8_t alpha = src[i];
+    dst[i] = src[i + 1];
+    dst[i + 1] = src[i + 2];
+    dst[i + 2] = src[i + 3];
+    dst[i + 3] = alpha;
+  }
+}
+
+uint64_t hashBytes(const uint8_t* data, size_t size, uint64_t seed) {
+  constexpr uint64_t PRIME = 0x100000001b3ULL;
+  uint64_t hash = 0xcbf29ce484222325ULL ^ seed;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * PRIME;
+    hash ^= hash >> 32;
+  }
+  for (; i < size; i++) {
+    hash = (hash ^ data[i]) * PRIME;
+  }
+  return hash ^ size;
+}
+
+int selectPixmapFrame(const std::vector<PixmapSize>& sizes, int target_size) {
+  int best = -1;
+  for (int i = 0; i < static_cast<int>(sizes.size()); i++) {
+    if (best < 0) {
+      best = i;
+      continue;
+    }
+    const auto& candidate = sizes[i];
+    const auto& current = sizes[best];
+    bool candidate_fits = candidate.height >= target_size;
+    bool current_fits = current.height >= target_size;
+    if (candidate_fits != current_fits) {
+      if (candidate_fits) best = i;
+    } else if (candidate_fits) {
+      // Both large enough: the smaller one needs less downscaling
+      if (candidate.width * candidate.height < current.width * current.height) best = i;
+    } else if (candidate.width * candidate.height > current.width * current.height) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+}  // namespace waybar::util
@@ -15,15 +15,14 @@
 
 namespace waybar::util {
 
-AudioBackend::AudioBackend(std::function<void()> on_updated_cb, private_constructor_tag tag)
+AudioBackend::AudioBackend(private_constructor_tag tag)
     : mainloop_(nullptr),
       mainloop_api_(nullptr),
       context_(nullptr),
       volume_(0),
       muted_(false),
       source_volume_(0),
-      source_muted_(false),
-      on_updated_cb_(std::move(on_updated_cb)) {
+      source_muted_(false) {
   // Initialize pa_volume_ with safe defaults
   pa_cvolume_init(&pa_volume_);
   mainloop_ = pa_threaded_mainloop_new();
@@ -55,9 +54,37 @@ AudioBackend::~AudioBackend() {
   }
 }
 
-std::shared_ptr<AudioBackend> AudioBackend::getInstance(std::function<void()> on_updated_cb) {
-  private_constructor_tag tag;
-  return std::make_shared<AudioBackend>(on_updated_cb, tag);
+std::shared_ptr<AudioBackend> AudioBackend::getInstance() {
+  static std::weak_ptr<AudioBackend> instance;
+  auto backend = instance.lock();
+  if (!backend) {
+    private_constructor_tag tag;
+    backend = std::make_shared<AudioBackend>(tag);
+    instance = backend;
+  }
+  return backend;
+}
+
+AudioBackend::SubscriptionId AudioBackend::subscribe(AudioTarget target,
+                                                     std::function<void()> on_updated) {
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  auto id = next_subscription_++;
+  subscribers_.emplace(id, Subscriber{target, std::move(on_updated)});
+  return id;
+}
+
+void AudioBackend::unsubscribe(SubscriptionId id) {
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  subscribers_.erase(id);
+}
+
+void AudioBackend::notify(AudioTarget target) {
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+  for (auto& [_, subscriber] : subscribers_) {
+    if ((static_cast<char>(subscriber.target) & static_cast<char>(target)) != 0) {
+      subscriber.on_updated();
+    }
+  }
 }
 
 void AudioBackend::connectContext() {
@@ -132,14 +159,43 @@ void AudioBackend::subscribeCb(pa_context* context, pa_subscription_event_type_t
   } else if (facility == PA_SUBSCRIPTION_EVENT_SINK) {
     pa_context_get_sink_info_by_index(context, idx, sinkInfoCb, data);
   } else if (facility == PA_SUBSCRIPTION_EVENT_SINK_INPUT) {
-    pa_context_get_sink_info_list(context, sinkInfoCb, data);
+    auto* backend = static_cast<AudioBackend*>(data);
+    if (!backend->sink_list_pending_) {
+      backend->sink_list_pending_ = true;
+      pa_context_get_sink_info_list(context, sinkListCb, data);
+    }
   } else if (facility == PA_SUBSCRIPTION_EVENT_SOURCE) {
     pa_context_get_source_info_by_index(context, idx, sourceInfoCb, data);
   } else if (facility == PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT) {
-    pa_context_get_source_info_list(context, sourceInfoCb, data);
+    auto* backend = static_cast<AudioBackend*>(data);
+    if (!backend->source_list_pending_) {
+      backend->source_list_pending_ = true;
+      pa_context_get_source_info_list(context, sourceListCb, data);
+    }
   }
 }
 
+/*
+ * Sink list requested for a sink-input event. Further events are ignored until it is complete.
+ */
+void AudioBackend::sinkListCb(pa_context* context, const pa_sink_info* i, int eol, void* data) {
+  if (eol != 0) {
+    static_cast<AudioBackend*>(data)->sink_list_pending_ = false;
+  }
+  sinkInfoCb(context, i, eol, data);
+}
+
+/*
+ * Source list requested for a source-output event.
+ */
+void AudioBackend::sourceListCb(pa_context* context, const pa_source_info* i, int eol,
+                                void* data) {
+  if (eol != 0) {
+    static_cast<AudioBackend*>(data)->source_list_pending_ = false;
+  }
+  sourceInfoCb(context, i, eol, data);
+}
+
 /*
  * Called in response to a volume change request
  */
@@ -223,7 +279,7 @@ void AudioBackend::sinkInfoCb(pa_context* /*context*/, const pa_sink_info* i, in
     } else {
       backend->form_factor_ = "";
     }
-    backend->on_updated_cb_();
+    backend->notify(AudioTarget::Sink);
   }
 }
 
@@ -240,7 +296,7 @@ void AudioBackend::sourceInfoCb(pa_context* /*context*/, const pa_source_info* i
     backend->source_muted_ = i->mute != 0;
     backend->source_desc_ = i->description;
     backend->source_port_name_ = i->active_port != nullptr ? i->active_port->name : "Unknown";
-    backend->on_updated_cb_();
+    backend->notify(AudioTarget::Source);
   }
 }
 
@@ -411,13 +467,19 @@ bool AudioBackend::isBluetooth() {
 }
 
 void AudioBackend::setIgnoredSinks(const Json::Value& config) {
-  if (config.isArray()) {
-    for (const auto& ignored_sink : config) {
-      if (ignored_sink.isString()) {
-        ignored_sinks_.push_back(ignored_sink.asString());
-      }
+  if (!config.isArray()) {
+    return;
+  }
+  // Read by the sink callbacks on the mainloop thread
+  pa_threaded_mainloop_lock(mainloop_);
+  for (const auto& ignored_sink : config) {
+    if (ignored_sink.isString() &&
+        std::find(ignored_sinks_.begin(), ignored_sinks_.end(), ignored_sink.asString()) ==
+            ignored_sinks_.end()) {
+      ignored_sinks_.push_back(ignored_sink.asString());
     }
   }
+  pa_threaded_mainloop_unlock(mainloop_);
 }
 
 }  // namespace waybar::util
@@ -0,0 +1,277 @@
+#include "util/desktop_app_index.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include "util/string.hpp"
+
+namespace waybar::util {
+
+namespace {
+
+const std::string DESKTOP_SUFFIX = ".desktop";
+const std::string KDE_PREFIX = "org.kde.";
+
+// Memoized app_id lookups are keyed by window titles too, so keep the table bounded
+constexpr size_t MAX_RESOLVED_ENTRIES = 1024;
+
+bool hasDesktopSuffix(const std::string& filename) {
+  return filename.size() > DESKTOP_SUFFIX.size() &&
+         filename.compare(filename.size() - DESKTOP_SUFFIX.size(), DESKTOP_SUFFIX.size(),
+                          DESKTOP_SUFFIX) == 0;
+}
+
+std::vector<std::pair<std::string, std::string>> listDesktopFiles(const std::string& dir) {
+  std::vector<std::pair<std::string, std::string>> result;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    auto filename = entry.path().filename().string();
+    if (!hasDesktopSuffix(filename) || !entry.is_regular_file(ec)) {
+      continue;
+    }
+    result.emplace_back(filename.substr(0, filename.size() - DESKTOP_SUFFIX.size()),
+                        entry.path().string());
+  }
+  return result;
+}
+
+}  // namespace
+
+DesktopAppIndex& DesktopAppIndex::getInstance() {
+  static DesktopAppIndex instance;
+  return instance;
+}
+
+DesktopAppIndex::DesktopAppIndex() : prefixes_(searchPrefixes()) {
+  for (const auto& prefix : prefixes_) {
+    if (prefix.empty()) {
+      continue;
+    }
+    watchDirectory(prefix + "applications/");
+    watchDirectory(prefix + "applications/kde/");
+  }
+}
+
+std::vector<std::string> DesktopAppIndex::searchPrefixes() {
+  std::vector<std::string> prefixes = {""};
+
+  const char* home_env = std::getenv("HOME");
+  std::string home_dir = home_env ? home_env : "";
+  if (!home_dir.empty()) {
+    prefixes.push_back(home_dir + "/.local/share/");
+  }
+
+  auto xdg_data_dirs = std::getenv("XDG_DATA_DIRS");
+  if (!xdg_data_dirs) {
+    prefixes.emplace_back("/usr/share/");
+    prefixes.emplace_back("/usr/local/share/");
+  } else {
+    std::string xdg_data_dirs_str(xdg_data_dirs);
+    size_t start = 0;
+    size_t end = 0;
+
+    do {
+      end = xdg_data_dirs_str.find(':', start);
+      auto p = xdg_data_dirs_str.substr(start, end - start);
+      prefixes.push_back(trim(p) + "/");
+
+      start = end == std::string::npos ? end : end + 1;
+    } while (end != std::string::npos);
+  }
+
+  for (auto& p : prefixes) spdlog::debug("Using 'desktop' search path prefix: {}", p);
+
+  return prefixes;
+}
+
+void DesktopAppIndex::watchDirectory(const std::string& dir) {
+  if (!std::filesystem::is_directory(dir)) {
+    return;
+  }
+  try {
+    auto monitor =
+        Gio::File::create_for_path(dir)->monitor_directory(Gio::FILE_MONITOR_WATCH_MOVES);
+    monitor->signal_changed().connect(
+        sigc::mem_fun(*this, &DesktopAppIndex::onDirectoryChanged));
+    monitors_.emplace_back(std::move(monitor));
+  } catch (const Glib::Error& e) {
+    spdlog::warn("Failed to watch desktop entry directory {}: {}", dir, std::string(e.what()));
+  }
+}
+
+void DesktopAppIndex::onDirectoryChanged(const Glib::RefPtr<Gio::File>& file,
+                                         const Glib::RefPtr<Gio::File>& /*other_file*/,
+                                         Gio::FileMonitorEvent event_type) {
+  switch (event_type) {
+    case Gio::FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+    case Gio::FILE_MONITOR_EVENT_DELETED:
+    case Gio::FILE_MONITOR_EVENT_CREATED:
+    case Gio::FILE_MONITOR_EVENT_RENAMED:
+    case Gio::FILE_MONITOR_EVENT_MOVED_IN:
+    case Gio::FILE_MONITOR_EVENT_MOVED_OUT:
+      spdlog::debug("Desktop entry changed: {}", file->get_path());
+      invalidate();
+      break;
+    default:
+      break;
+  }
+}
+
+void DesktopAppIndex::invalidate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  dirty_ = true;
+  generation_++;
+  resolved_.clear();
+}
+
+std::string DesktopAppIndex::readStartupWMClass(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+  bool in_desktop_entry = false;
+  while (std::getline(file, line)) {
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+    if (line.front() == '[') {
+      if (in_desktop_entry) {
+        break;
+      }
+      in_desktop_entry = line.starts_with("[Desktop Entry]");
+      continue;
+    }
+    if (in_desktop_entry && line.starts_with("StartupWMClass")) {
+      auto pos = line.find('=');
+      if (pos != std::string::npos && trim(line.substr(14, pos - 14)).empty()) {
+        return trim(line.substr(pos + 1));
+      }
+    }
+  }
+  return "";
+}
+
+void DesktopAppIndex::scanPrefix(const std::string& prefix) {
+  // Same precedence as the on-disk probing order: data dir root, applications/,
+  // applications/kde/ and finally "org.kde.<name>" aliases in applications/.
+  std::vector<std::pair<std::string, std::string>> kde_aliases;
+  for (const auto* folder : {"", "applications/", "applications/kde/"}) {
+    for (auto& [name, path] : listDesktopFiles(prefix + folder)) {
+      by_name_.try_emplace(name, path);
+      by_lower_name_.try_emplace(toLower(name), path);
+
+      auto wm_class = readStartupWMClass(path);
+      if (!wm_class.empty()) {
+        by_wm_class_.try_emplace(wm_class, path);
+        by_lower_wm_class_.try_emplace(toLower(wm_class), path);
+      }
+
+      if (name.starts_with(KDE_PREFIX)) {
+        kde_aliases.emplace_back(name.substr(KDE_PREFIX.size()), path);
+      }
+    }
+  }
+  for (auto& [name, path] : kde_aliases) {
+    by_name_.try_emplace(name, path);
+    by_lower_name_.try_emplace(toLower(name), path);
+  }
+}
+
+void DesktopAppIndex::ensureLoaded() {
+  if (!dirty_) {
+    return;
+  }
+  by_name_.clear();
+  by_lower_name_.clear();
+  by_wm_class_.clear();
+  by_lower_wm_class_.clear();
+  app_infos_.clear();
+
+  for (const auto& prefix : prefixes_) {
+    if (!prefix.empty()) {
+      scanPrefix(prefix);
+    }
+  }
+  dirty_ = false;
+  spdlog::debug("Indexed {} desktop entries", by_name_.size());
+}
+
+DesktopAppIndex::AppInfo DesktopAppIndex::appInfoFor(const std::string& path) {
+  auto it = app_infos_.find(path);
+  if (it != app_infos_.end()) {
+    return it->second;
+  }
+  auto app_info = Gio::DesktopAppInfo::create_from_filename(path);
+  app_infos_.emplace(path, app_info);
+  return app_info;
+}
+
+DesktopAppIndex::AppInfo DesktopAppIndex::findByName(const std::string& name) {
+  if (name.empty()) {
+    return {};
+  }
+  // Absolute paths were always accepted as-is
+  if (name.front() == '/') {
+    auto app_info = Gio::DesktopAppInfo::create_from_filename(name);
+    if (app_info) {
+      return app_info;
+    }
+  }
+
+  // Desktop ids as returned by g_desktop_app_info_search carry the suffix
+  auto stem = hasDesktopSuffix(name) ? name.substr(0, name.size() - DESKTOP_SUFFIX.size()) : name;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ensureLoaded();
+  auto it = by_name_.find(stem);
+  if (it == by_name_.end()) {
+    it = by_lower_name_.find(toLower(stem));
+    if (it == by_lower_name_.end()) {
+      return {};
+    }
+  }
+  return appInfoFor(it->second);
+}
+
+DesktopAppIndex::AppInfo DesktopAppIndex::findByStartupWMClass(const std::string& wm_class) {
+  if (wm_class.empty()) {
+    return {};
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  ensureLoaded();
+  auto it = by_wm_class_.find(wm_class);
+  if (it == by_wm_class_.end()) {
+    it = by_lower_wm_class_.find(toLower(wm_class));
+    if (it == by_lower_wm_class_.end()) {
+      return {};
+    }
+  }
+  return appInfoFor(it->second);
+}
+
+DesktopAppIndex::AppInfo DesktopAppIndex::memoize(const std::string& key,
+                                                  const std::function<AppInfo()>& resolve) {
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = resolved_.find(key);
+    if (it != resolved_.end()) {
+      return it->second;
+    }
+    generation = generation_;
+  }
+
+  auto app_info = resolve();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (generation == generation_) {
+    if (resolved_.size() >= MAX_RESOLVED_ENTRIES) {
+      resolved_.clear();
+    }
+    resolved_.emplace(key, app_info);
+  }
+  return app_info;
+}
+
+}  // namespace waybar::util
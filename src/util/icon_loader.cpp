@@ -1,62 +1,11 @@
 #include "util/icon_loader.hpp"
 
+#include "util/desktop_app_index.hpp"
+#include "util/icon_surface_cache.hpp"
 #include "util/string.hpp"
 
-std::vector<std::string> IconLoader::search_prefix() {
-  std::vector<std::string> prefixes = {""};
-
-  const char* home_env = std::getenv("HOME");
-  std::string home_dir = home_env ? home_env : "";
-  if (!home_dir.empty()) {
-    prefixes.push_back(home_dir + "/.local/share/");
-  }
-
-  auto xdg_data_dirs = std::getenv("XDG_DATA_DIRS");
-  if (!xdg_data_dirs) {
-    prefixes.emplace_back("/usr/share/");
-    prefixes.emplace_back("/usr/local/share/");
-  } else {
-    std::string xdg_data_dirs_str(xdg_data_dirs);
-    size_t start = 0;
-    size_t end = 0;
-
-    do {
-      end = xdg_data_dirs_str.find(':', start);
-      auto p = xdg_data_dirs_str.substr(start, end - start);
-      prefixes.push_back(trim(p) + "/");
-
-      start = end == std::string::npos ? end : end + 1;
-    } while (end != std::string::npos);
-  }
-
-  for (auto& p : prefixes) spdlog::debug("Using 'desktop' search path prefix: {}", p);
-
-  return prefixes;
-}
-
 Glib::RefPtr<Gio::DesktopAppInfo> IconLoader::get_app_info_by_name(const std::string& app_id) {
-  static std::vector<std::string> prefixes = search_prefix();
-
-  std::vector<std::string> app_folders = {"", "applications/", "applications/kde/",
-                                          "applications/org.kde."};
-
-  std::vector<std::string> suffixes = {"", ".desktop"};
-
-  for (auto const& prefix : prefixes) {
-    for (auto const& folder : app_folders) {
-      for (auto const& suffix : suffixes) {
-        auto app_info_ =
-            Gio::DesktopAppInfo::create_from_filename(prefix + folder + app_id + suffix);
-        if (!app_info_) {
-          continue;
-        }
-
-        return app_info_;
-      }
-    }
-  }
-
-  return {};
+  return waybar::util::DesktopAppIndex::getInstance().findByName(app_id);
 }
 
 Glib::RefPtr<Gio::DesktopAppInfo> IconLoader::get_desktop_app_info(const std::string& app_id) {
@@ -65,6 +14,11 @@ Glib::RefPtr<Gio::DesktopAppInfo> IconLoader::get_desktop_app_info(const std::st
     return app_info;
   }
 
+  app_info = waybar::util::DesktopAppIndex::getInstance().findByStartupWMClass(app_id);
+  if (app_info) {
+    return app_info;
+  }
+
   std::string desktop_file = "";
 
   gchar*** desktop_list = g_desktop_app_info_search(app_id.c_str());
@@ -109,6 +63,7 @@ std::string IconLoader::get_icon_name_from_icon_theme(
 }
 
 bool IconLoader::image_load_icon(Gtk::Image& image, const Glib::RefPtr<Gtk::IconTheme>& icon_theme,
+                                 const std::string& theme_name,
                                  Glib::RefPtr<Gio::DesktopAppInfo> app_info, int size) {
   std::string ret_icon_name = "unknown";
   if (app_info) {
@@ -123,31 +78,28 @@ bool IconLoader::image_load_icon(Gtk::Image& image, const Glib::RefPtr<Gtk::Icon
     }
   }
 
-  Glib::RefPtr<Gdk::Pixbuf> pixbuf;
-  auto scaled_icon_size = size * image.get_scale_factor();
-
-  try {
-    pixbuf = icon_theme->load_icon(ret_icon_name, scaled_icon_size, Gtk::ICON_LOOKUP_FORCE_SIZE);
-  } catch (...) {
-    if (Glib::file_test(ret_icon_name, Glib::FILE_TEST_EXISTS)) {
-      pixbuf = load_icon_from_file(ret_icon_name, scaled_icon_size);
-    } else {
-      try {
-        pixbuf = DefaultGtkIconThemeWrapper::load_icon(
-            "image-missing", scaled_icon_size, Gtk::IconLookupFlags::ICON_LOOKUP_FORCE_SIZE);
-      } catch (...) {
-        pixbuf = {};
-      }
-    }
-  }
+  auto scale = image.get_scale_factor();
+  auto scaled_icon_size = size * scale;
+
+  auto surface = waybar::util::IconSurfaceCache::getInstance().get(
+      {ret_icon_name, scaled_icon_size, scale, theme_name}, [&]() -> Glib::RefPtr<Gdk::Pixbuf> {
+        try {
+          return icon_theme->load_icon(ret_icon_name, scaled_icon_size,
+                                       Gtk::ICON_LOOKUP_FORCE_SIZE);
+        } catch (...) {
+          if (Glib::file_test(ret_icon_name, Glib::FILE_TEST_EXISTS)) {
+            return load_icon_from_file(ret_icon_name, scaled_icon_size);
+          }
+          try {
+            return DefaultGtkIconThemeWrapper::load_icon(
+                "image-missing", scaled_icon_size, Gtk::IconLookupFlags::ICON_LOOKUP_FORCE_SIZE);
+          } catch (...) {
+            return {};
+          }
+        }
+      });
 
-  if (pixbuf) {
-    if (pixbuf->get_width() != scaled_icon_size && pixbuf->get_height() > 0) {
-      int width = scaled_icon_size * pixbuf->get_width() / pixbuf->get_height();
-      pixbuf = pixbuf->scale_simple(width, scaled_icon_size, Gdk::InterpType::INTERP_BILINEAR);
-    }
-    auto surface = Gdk::Cairo::create_surface_from_pixbuf(pixbuf, image.get_scale_factor(),
-                                                          image.get_window());
+  if (surface) {
     image.set(surface);
     return true;
   }
@@ -158,22 +110,28 @@ bool IconLoader::image_load_icon(Gtk::Image& image, const Glib::RefPtr<Gtk::Icon
 void IconLoader::add_custom_icon_theme(const std::string& theme_name) {
   auto icon_theme = Gtk::IconTheme::create();
   icon_theme->set_custom_theme(theme_name);
-  custom_icon_themes_.push_back(icon_theme);
+  custom_icon_themes_.emplace_back(theme_name, icon_theme);
   spdlog::debug("Use custom icon theme: {}", theme_name);
 }
 
 bool IconLoader::image_load_icon(Gtk::Image& image, Glib::RefPtr<Gio::DesktopAppInfo> app_info,
                                  int size) const {
-  for (auto& icon_theme : custom_icon_themes_) {
-    if (image_load_icon(image, icon_theme, app_info, size)) {
+  for (const auto& [theme_name, icon_theme] : custom_icon_themes_) {
+    if (image_load_icon(image, icon_theme, theme_name, app_info, size)) {
       return true;
     }
   }
-  return image_load_icon(image, default_icon_theme_, app_info, size);
+  return image_load_icon(image, default_icon_theme_, "", app_info, size);
 }
 
 Glib::RefPtr<Gio::DesktopAppInfo> IconLoader::get_app_info_from_app_id_list(
     const std::string& app_id_list) {
+  return waybar::util::DesktopAppIndex::getInstance().memoize(
+      app_id_list, [&app_id_list] { return resolve_app_id_list(app_id_list); });
+}
+
+Glib::RefPtr<Gio::DesktopAppInfo> IconLoader::resolve_app_id_list(
+    const std::string& app_id_list) {
   std::string app_id;
   std::istringstream stream(app_id_list);
   Glib::RefPtr<Gio::DesktopAppInfo> app_info_;
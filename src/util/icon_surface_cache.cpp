@@ -0,0 +1,102 @@
+#include "util/icon_surface_cache.hpp"
+
+#include <gdkmm/general.h>
+#include <gtkmm/icontheme.h>
+#include <spdlog/spdlog.h>
+
+namespace waybar::util {
+
+size_t IconSurfaceKeyHash::operator()(const IconSurfaceKey& key) const {
+  size_t seed = std::hash<std::string>{}(key.name);
+  auto combine = [&seed](size_t value) {
+    seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+  };
+  combine(std::hash<int>{}(key.size));
+  combine(std::hash<int>{}(key.scale));
+  combine(std::hash<std::string>{}(key.theme));
+  return seed;
+}
+
+IconSurfaceCache& IconSurfaceCache::getInstance() {
+  static IconSurfaceCache instance;
+  return instance;
+}
+
+IconSurfaceCache::IconSurfaceCache() {
+  Gtk::IconTheme::get_default()->signal_changed().connect([this] {
+    spdlog::debug("Icon theme changed, dropping {} cached icon surfaces", size());
+    clear();
+  });
+}
+
+IconSurfaceCache::Surface IconSurfaceCache::get(const IconSurfaceKey& key, const Loader& load) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return it->second->surface;
+    }
+  }
+
+  Glib::RefPtr<Gdk::Pixbuf> pixbuf;
+  try {
+    pixbuf = load();
+  } catch (const Glib::Error& e) {
+    spdlog::debug("Failed to load icon {}: {}", key.name, std::string(e.what()));
+  }
+  if (!pixbuf) {
+    return {};
+  }
+
+  if (pixbuf->get_height() > 0 && pixbuf->get_height() != key.size) {
+    int width = key.size * pixbuf->get_width() / pixbuf->get_height();
+    pixbuf = pixbuf->scale_simple(width, key.size, Gdk::InterpType::INTERP_BILINEAR);
+  }
+  // Surfaces are shared across bars, so create them without a reference window
+  auto surface =
+      Gdk::Cairo::create_surface_from_pixbuf(pixbuf, key.scale, Glib::RefPtr<Gdk::Window>());
+  size_t entry_bytes = static_cast<size_t>(pixbuf->get_width()) * pixbuf->get_height() * 4;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    // Loaded concurrently, keep the first one
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->surface;
+  }
+  lru_.push_front(Entry{key, surface, entry_bytes});
+  index_.emplace(key, lru_.begin());
+  bytes_ += entry_bytes;
+  evict();
+  return surface;
+}
+
+void IconSurfaceCache::evict() {
+  // Never evict the most recently inserted entry, even if it alone exceeds the budget
+  while (bytes_ > max_bytes_ && lru_.size() > 1) {
+    auto& entry = lru_.back();
+    bytes_ -= entry.bytes;
+    index_.erase(entry.key);
+    lru_.pop_back();
+  }
+}
+
+void IconSurfaceCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  lru_.clear();
+  bytes_ = 0;
+}
+
+size_t IconSurfaceCache::bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+size_t IconSurfaceCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return lru_.size();
+}
+
+}  // namespace waybar::util
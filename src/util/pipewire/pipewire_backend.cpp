@@ -6,9 +6,7 @@ namespace waybar::util::PipewireBackend {
 
 static void getNodeInfo(void* data_, const struct pw_node_info* info) {
   auto* pNodeInfo = static_cast<PrivacyNodeInfo*>(data_);
-  pNodeInfo->handleNodeEventInfo(info);
-
-  static_cast<PipewireBackend*>(pNodeInfo->data)->privacy_nodes_changed_signal_event.emit();
+  static_cast<PipewireBackend*>(pNodeInfo->data)->handleNodeEventInfo(pNodeInfo, info);
 }
 
 static const struct pw_node_events NODE_EVENTS = {
@@ -17,7 +15,10 @@ static const struct pw_node_events NODE_EVENTS = {
 };
 
 static void proxyDestroy(void* data) {
-  static_cast<PrivacyNodeInfo*>(data)->handleProxyEventDestroy();
+  auto* pNodeInfo = static_cast<PrivacyNodeInfo*>(data);
+  pNodeInfo->handleProxyEventDestroy();
+  // The user data is freed right after this event
+  pNodeInfo->~PrivacyNodeInfo();
 }
 
 static const struct pw_proxy_events PROXY_EVENTS = {
@@ -83,6 +84,14 @@ PipewireBackend::~PipewireBackend() {
     pw_thread_loop_lock(mainloop_);
   }
 
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [_, node] : privacy_nodes_) {
+      pw_proxy_destroy(node->proxy);
+    }
+    privacy_nodes_.clear();
+  }
+
   if (registry_ != nullptr) {
     pw_proxy_destroy((struct pw_proxy*)registry_);
   }
@@ -105,8 +114,37 @@ PipewireBackend::~PipewireBackend() {
 }
 
 std::shared_ptr<PipewireBackend> PipewireBackend::getInstance() {
-  PrivateConstructorTag tag;
-  return std::make_shared<PipewireBackend>(tag);
+  static std::weak_ptr<PipewireBackend> instance;
+  auto backend = instance.lock();
+  if (!backend) {
+    PrivateConstructorTag tag;
+    backend = std::make_shared<PipewireBackend>(tag);
+    instance = backend;
+  }
+  return backend;
+}
+
+PipewireBackend::SubscriptionId PipewireBackend::subscribe(Subscriber subscriber) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& [_, node] : privacy_nodes_) {
+    if (node->announced) {
+      subscriber({PrivacyNodeChange::Kind::Added, *node});
+    }
+  }
+  auto id = next_subscription_++;
+  subscribers_.emplace(id, std::move(subscriber));
+  return id;
+}
+
+void PipewireBackend::unsubscribe(SubscriptionId id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  subscribers_.erase(id);
+}
+
+void PipewireBackend::notify(const PrivacyNodeChange& change) {
+  for (auto& [_, subscriber] : subscribers_) {
+    subscriber(change);
+  }
 }
 
 void PipewireBackend::handleRegistryEventGlobal(uint32_t id, uint32_t permissions, const char* type,
@@ -134,6 +172,7 @@ void PipewireBackend::handleRegistryEventGlobal(uint32_t id, uint32_t permission
   auto* pNodeInfo = (PrivacyNodeInfo*)pw_proxy_get_user_data(proxy);
   new (pNodeInfo) PrivacyNodeInfo{};
   pNodeInfo->id = id;
+  pNodeInfo->proxy = proxy;
   pNodeInfo->data = this;
   pNodeInfo->type = mediaType;
   pNodeInfo->media_class = mediaClass;
@@ -144,20 +183,35 @@ void PipewireBackend::handleRegistryEventGlobal(uint32_t id, uint32_t permission
 
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    privacy_nodes.insert_or_assign(id, pNodeInfo);
+    privacy_nodes_.insert_or_assign(id, pNodeInfo);
   }
 }
 
 void PipewireBackend::handleRegistryEventGlobalRemove(uint32_t id) {
-  mutex_.lock();
-  auto iter = privacy_nodes.find(id);
-  if (iter != privacy_nodes.end()) {
-    privacy_nodes[id]->~PrivacyNodeInfo();
-    privacy_nodes.erase(id);
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Links, ports and every other kind of object are removed here as well
+  auto iter = privacy_nodes_.find(id);
+  if (iter == privacy_nodes_.end()) {
+    return;
   }
-  mutex_.unlock();
+  auto* pNodeInfo = iter->second;
+  privacy_nodes_.erase(iter);
+  if (pNodeInfo->announced) {
+    notify({PrivacyNodeChange::Kind::Removed, *pNodeInfo});
+  }
+  pw_proxy_destroy(pNodeInfo->proxy);
+}
 
-  privacy_nodes_changed_signal_event.emit();
+void PipewireBackend::handleNodeEventInfo(PrivacyNodeInfo* node, const struct pw_node_info* info) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool changed = node->handleNodeEventInfo(info);
+  if (node->announced && !changed) {
+    return;
+  }
+  auto kind = node->announced ? PrivacyNodeChange::Kind::StateChanged
+                              : PrivacyNodeChange::Kind::Added;
+  node->announced = true;
+  notify({kind, *node});
 }
 
 }  // namespace waybar::util::PipewireBackend
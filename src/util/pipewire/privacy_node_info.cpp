@@ -2,8 +2,8 @@
 
 namespace waybar::util::PipewireBackend {
 
-std::string PrivacyNodeInfo::getName() {
-  const std::vector<std::string*> names{&application_name, &node_name};
+std::string PrivacyNode::getName() const {
+  const std::vector<const std::string*> names{&application_name, &node_name};
   std::string name = "Unknown Application";
   for (const auto& item : names) {
     if (item != nullptr && !item->empty()) {
@@ -15,9 +15,10 @@ std::string PrivacyNodeInfo::getName() {
   return name;
 }
 
-std::string PrivacyNodeInfo::getIconName() {
-  const std::vector<std::string*> names{&application_icon_name, &pipewire_access_portal_app_id,
-                                        &application_name, &node_name};
+std::string PrivacyNode::getIconName() const {
+  const std::vector<const std::string*> names{&application_icon_name,
+                                              &pipewire_access_portal_app_id, &application_name,
+                                              &node_name};
   std::string name = "application-x-executable-symbolic";
   for (const auto& item : names) {
     if (item != nullptr && !item->empty() && DefaultGtkIconThemeWrapper::has_icon(*item)) {
@@ -32,9 +33,14 @@ void PrivacyNodeInfo::handleProxyEventDestroy() {
   spa_hook_remove(&object_listener);
 }
 
-void PrivacyNodeInfo::handleNodeEventInfo(const struct pw_node_info* info) {
+bool PrivacyNodeInfo::handleNodeEventInfo(const struct pw_node_info* info) {
+  const PrivacyNode previous = *this;
   state = info->state;
 
+  // Parameter changes come with neither, they are frequent on busy audio setups
+  if ((info->change_mask & PW_NODE_CHANGE_MASK_PROPS) == 0 || info->props == nullptr) {
+    return previous != *this;
+  }
   const struct spa_dict_item* item;
   spa_dict_for_each(item, info->props) {
     if (strcmp(item->key, PW_KEY_CLIENT_ID) == 0) {
@@ -53,6 +59,7 @@ void PrivacyNodeInfo::handleNodeEventInfo(const struct pw_node_info* info) {
       is_monitor = strcmp(item->value, "true") == 0;
     }
   }
+  return previous != *this;
 }
 
 }  // namespace waybar::util::PipewireBackend
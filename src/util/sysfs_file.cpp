@@ -0,0 +1,54 @@
+#include "util/sysfs_file.hpp"
+
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cerrno>
+
+namespace waybar::util {
+
+SysfsFile::SysfsFile(const std::filesystem::path& path)
+    : fd_(open(path.c_str(), O_RDONLY | O_CLOEXEC)) {}
+
+std::optional<std::string> SysfsFile::read() const {
+  std::string contents;
+  if (!read(contents)) {
+    return std::nullopt;
+  }
+  return contents;
+}
+
+bool SysfsFile::read(std::string& contents) const {
+  if (!isOpen()) {
+    contents.clear();
+    return false;
+  }
+  // Read straight into the buffer, which only grows for contents larger than any before
+  contents.resize(std::max<size_t>(contents.capacity(), 4096));
+  size_t size = 0;
+  while (true) {
+    if (size == contents.size()) {
+      contents.resize(size * 2);
+    }
+    auto n = pread(fd_.get(), contents.data() + size, contents.size() - size, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      contents.clear();
+      return false;
+    }
+    if (n == 0) break;
+    size += n;
+  }
+  contents.resize(size);
+  return true;
+}
+
+std::optional<std::string> SysfsFile::readLine() const {
+  auto contents = read();
+  if (contents) {
+    contents->resize(std::min(contents->find('\n'), contents->size()));
+  }
+  return contents;
+}
+
+}  // namespace waybar::util
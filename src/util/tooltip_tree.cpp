@@ -0,0 +1,92 @@
+#include "util/tooltip_tree.hpp"
+
+#include <iterator>
+
+#include "util/gtk_icon.hpp"
+
+namespace waybar::util {
+
+TooltipTree::TooltipTree(Gtk::Orientation orientation, int spacing, int icon_size)
+    : root_{orientation},
+      cell_orientation_{orientation == Gtk::ORIENTATION_HORIZONTAL ? Gtk::ORIENTATION_VERTICAL
+                                                                   : Gtk::ORIENTATION_HORIZONTAL},
+      spacing_{spacing},
+      icon_size_{icon_size} {
+  root_.show();
+}
+
+TooltipTree::Cell& TooltipTree::cell(const std::string& key, size_t index) {
+  auto it = rows_.find(key);
+  if (it == rows_.end()) {
+    it = rows_.emplace(key, std::make_unique<Row>()).first;
+    auto& box = it->second->box;
+    box.set_orientation(cell_orientation_);
+    box.set_spacing(spacing_);
+    root_.add(box);
+    root_.reorder_child(box, std::distance(rows_.begin(), it));
+    box.show();
+  }
+  auto& cells = it->second->cells;
+  while (cells.size() <= index) {
+    auto& cell = *cells.emplace_back(std::make_unique<Cell>());
+    cell.box.set_orientation(cell_orientation_);
+    cell.icon.set_pixel_size(icon_size_);
+    cell.box.add(cell.icon);
+    cell.box.add(cell.label);
+    cell.label.show();
+    it->second->box.add(cell.box);
+    cell.box.show();
+  }
+  return *cells[index];
+}
+
+void TooltipTree::setIcon(const std::string& key, size_t index, const std::string& name) {
+  auto& cell = this->cell(key, index);
+  if (cell.icon.get_visible() && cell.icon_name == name) {
+    return;
+  }
+  cell.icon_name = name;
+  // The theme is only asked when the icon changes
+  const auto& shown = name.empty() || !DefaultGtkIconThemeWrapper::has_icon(name) ? fallback_icon_
+                                                                                  : name;
+  cell.icon.set_from_icon_name(shown, Gtk::ICON_SIZE_INVALID);
+  cell.icon.show();
+}
+
+void TooltipTree::setText(const std::string& key, size_t index, const Glib::ustring& text) {
+  setLabel(cell(key, index), text, false);
+}
+
+void TooltipTree::setMarkup(const std::string& key, size_t index, const Glib::ustring& markup) {
+  setLabel(cell(key, index), markup, true);
+}
+
+void TooltipTree::setLabel(Cell& cell, const Glib::ustring& text, bool markup) {
+  if (cell.markup == markup && cell.text == text) {
+    return;
+  }
+  cell.text = text;
+  cell.markup = markup;
+  if (markup) {
+    cell.label.set_markup(text);
+  } else {
+    cell.label.set_text(text);
+  }
+}
+
+void TooltipTree::remove(const std::string& key) {
+  auto it = rows_.find(key);
+  if (it != rows_.end()) {
+    root_.remove(it->second->box);
+    rows_.erase(it);
+  }
+}
+
+void TooltipTree::clear() {
+  for (auto& [key, row] : rows_) {
+    root_.remove(row->box);
+  }
+  rows_.clear();
+}
+
+}  // namespace waybar::util
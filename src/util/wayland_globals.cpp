@@ -0,0 +1,47 @@
+#include "util/wayland_globals.hpp"
+
+#include <algorithm>
+
+namespace waybar::util {
+
+void WaylandGlobals::reset(wl_registry* registry) {
+  registry_ = registry;
+  globals_.clear();
+  // Objects of the previous registry stay valid as long as their owners hold them
+  shared_.clear();
+}
+
+void WaylandGlobals::add(uint32_t name, const char* interface, uint32_t version) {
+  globals_.push_back({name, interface, version});
+}
+
+void WaylandGlobals::remove(uint32_t name) {
+  std::erase_if(globals_, [name](const auto& global) { return global.name == name; });
+}
+
+const WaylandGlobals::Global* WaylandGlobals::find(const char* interface) const {
+  auto it = std::find_if(globals_.begin(), globals_.end(), [interface](const auto& global) {
+    return global.interface == interface;
+  });
+  return it != globals_.end() ? &*it : nullptr;
+}
+
+uint32_t WaylandGlobals::version(const wl_interface& interface) const {
+  const auto* global = find(interface.name);
+  return global != nullptr ? global->version : 0;
+}
+
+uint32_t WaylandGlobals::boundVersion(const wl_interface& interface, uint32_t max_version) const {
+  return std::min({version(interface), max_version, static_cast<uint32_t>(interface.version)});
+}
+
+void* WaylandGlobals::bindGlobal(const wl_interface& interface, uint32_t max_version) const {
+  const auto* global = find(interface.name);
+  uint32_t version = boundVersion(interface, max_version);
+  if (registry_ == nullptr || global == nullptr || version == 0) {
+    return nullptr;
+  }
+  return wl_registry_bind(registry_, global->name, &interface, version);
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,183 @@
+#include "util/wireplumber_context.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <stdexcept>
+
+namespace waybar::util {
+
+std::shared_ptr<WireplumberContext> WireplumberContext::getInstance() {
+  static std::weak_ptr<WireplumberContext> instance;
+  auto context = instance.lock();
+  if (!context) {
+    context = std::make_shared<WireplumberContext>(private_constructor_tag{});
+    instance = context;
+  }
+  return context;
+}
+
+WireplumberContext::WireplumberContext(private_constructor_tag /*tag*/) {
+  wp_init(WP_INIT_PIPEWIRE);
+  wp_core_ = wp_core_new(nullptr, nullptr, nullptr);
+  apis_ = g_ptr_array_new_with_free_func(g_object_unref);
+  om_ = wp_object_manager_new();
+  cancellable_ = g_cancellable_new();
+
+  // Nodes of every media class are watched: the object manager can't take new interests once
+  // installed, and a module asking for another node-type may be created after that
+  wp_object_manager_add_interest(om_, WP_TYPE_NODE, WP_CONSTRAINT_TYPE_PW_PROPERTY, "media.class",
+                                 "+", nullptr);
+
+  spdlog::debug("wireplumber: connecting to pipewire...");
+
+  if (wp_core_connect(wp_core_) == 0) {
+    spdlog::error("wireplumber: Could not connect to PipeWire");
+    g_clear_object(&cancellable_);
+    g_clear_object(&om_);
+    g_clear_pointer(&apis_, g_ptr_array_unref);
+    g_clear_object(&wp_core_);
+    throw std::runtime_error("Could not connect to PipeWire\n");
+  }
+
+  spdlog::debug("wireplumber: connected!");
+
+  g_signal_connect_swapped(om_, "installed", (GCallback)onObjectManagerInstalled, this);
+
+  spdlog::debug("wireplumber: loading default nodes api module");
+  wp_core_load_component(wp_core_, "libwireplumber-module-default-nodes-api", "module", nullptr,
+                         "default-nodes-api", cancellable_,
+                         (GAsyncReadyCallback)onDefaultNodesApiLoaded, this);
+}
+
+WireplumberContext::~WireplumberContext() {
+  g_cancellable_cancel(cancellable_);
+  if (mixer_api_ != nullptr) {
+    g_signal_handlers_disconnect_by_data(mixer_api_, this);
+  }
+  if (def_nodes_api_ != nullptr) {
+    g_signal_handlers_disconnect_by_data(def_nodes_api_, this);
+  }
+  if (om_ != nullptr) {
+    g_signal_handlers_disconnect_by_data(om_, this);
+  }
+  wp_core_disconnect(wp_core_);
+  g_clear_pointer(&apis_, g_ptr_array_unref);
+  g_clear_object(&om_);
+  g_clear_object(&wp_core_);
+  g_clear_object(&mixer_api_);
+  g_clear_object(&def_nodes_api_);
+  g_clear_object(&cancellable_);
+}
+
+sigc::connection WireplumberContext::connectNode(uint32_t id, const sigc::slot<void()>& slot) {
+  // Drop signals nobody listens to anymore
+  std::erase_if(node_signals_, [](const auto& entry) { return entry.second.empty(); });
+  return node_signals_[id].connect(slot);
+}
+
+void WireplumberContext::onMixerChanged(WireplumberContext* self, uint32_t id) {
+  auto it = self->node_signals_.find(id);
+  if (it == self->node_signals_.end()) {
+    return;
+  }
+  it->second.emit();
+}
+
+void WireplumberContext::onDefaultNodesApiChanged(WireplumberContext* self) {
+  self->signal_default_nodes_changed_.emit();
+}
+
+void WireplumberContext::onObjectManagerInstalled(WireplumberContext* self) {
+  spdlog::debug("wireplumber: onObjectManagerInstalled");
+
+  self->def_nodes_api_ = wp_plugin_find(self->wp_core_, "default-nodes-api");
+
+  if (self->def_nodes_api_ == nullptr) {
+    spdlog::error("wireplumber: default nodes api is not loaded.");
+    return;
+  }
+
+  self->mixer_api_ = wp_plugin_find(self->wp_core_, "mixer-api");
+
+  if (self->mixer_api_ == nullptr) {
+    spdlog::error("wireplumber: mixer api is not loaded.");
+    return;
+  }
+
+  g_signal_connect_swapped(self->mixer_api_, "changed", (GCallback)onMixerChanged, self);
+  g_signal_connect_swapped(self->def_nodes_api_, "changed", (GCallback)onDefaultNodesApiChanged,
+                           self);
+
+  self->ready_ = true;
+  self->signal_ready_.emit();
+}
+
+void WireplumberContext::onPluginActivated(WpObject* p, GAsyncResult* res,
+                                           WireplumberContext* self) {
+  g_autoptr(GError) error = nullptr;
+
+  if (wp_object_activate_finish(p, res, &error) == 0) {
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == 0) {
+      spdlog::error("wireplumber: error activating plugin: {}", error->message);
+    }
+    return;
+  }
+
+  spdlog::debug("wireplumber: onPluginActivated: {}", wp_plugin_get_name(WP_PLUGIN(p)));
+  if (--self->pending_plugins_ == 0) {
+    wp_core_install_object_manager(self->wp_core_, self->om_);
+  }
+}
+
+void WireplumberContext::activatePlugins() {
+  spdlog::debug("wireplumber: activating plugins");
+  for (uint16_t i = 0; i < apis_->len; i++) {
+    WpPlugin* plugin = static_cast<WpPlugin*>(g_ptr_array_index(apis_, i));
+    pending_plugins_++;
+    wp_object_activate(WP_OBJECT(plugin), WP_PLUGIN_FEATURE_ENABLED, cancellable_,
+                       (GAsyncReadyCallback)onPluginActivated, this);
+  }
+}
+
+void WireplumberContext::onDefaultNodesApiLoaded(WpObject* p, GAsyncResult* res,
+                                                 WireplumberContext* self) {
+  g_autoptr(GError) error = nullptr;
+
+  // self is gone if the load was cancelled, so only the error may be inspected
+  if (wp_core_load_component_finish(WP_CORE(p), res, &error) == FALSE) {
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == 0) {
+      spdlog::error("wireplumber: default nodes API load failed");
+    }
+    return;
+  }
+  spdlog::debug("wireplumber: loaded default nodes api");
+  g_ptr_array_add(self->apis_, wp_plugin_find(self->wp_core_, "default-nodes-api"));
+
+  spdlog::debug("wireplumber: loading mixer api module");
+  wp_core_load_component(self->wp_core_, "libwireplumber-module-mixer-api", "module", nullptr,
+                         "mixer-api", self->cancellable_, (GAsyncReadyCallback)onMixerApiLoaded,
+                         self);
+}
+
+void WireplumberContext::onMixerApiLoaded(WpObject* p, GAsyncResult* res,
+                                          WireplumberContext* self) {
+  g_autoptr(GError) error = nullptr;
+
+  if (wp_core_load_component_finish(WP_CORE(p), res, &error) == FALSE) {
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == 0) {
+      spdlog::error("wireplumber: mixer API load failed");
+    }
+    return;
+  }
+
+  spdlog::debug("wireplumber: loaded mixer API");
+  g_ptr_array_add(self->apis_, ({
+                    WpPlugin* plugin = wp_plugin_find(self->wp_core_, "mixer-api");
+                    g_object_set(G_OBJECT(plugin), "scale", 1 /* cubic */, nullptr);
+                    plugin;
+                  }));
+
+  self->activatePlugins();
+}
+
+}  // namespace waybar::util
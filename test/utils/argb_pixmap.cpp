@@ -0,0 +1,62 @@
+#include "util/argb_pixmap.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <vector>
+
+using waybar::util::argbToRgba;
+using waybar::util::hashBytes;
+using waybar::util::PixmapSize;
+using waybar::util::selectPixmapFrame;
+
+TEST_CASE("Convert ARGB pixmaps to RGBA", "[argb_pixmap]") {
+  // Cover the vector body and the scalar tail for every implementation
+  for (size_t pixels : {0, 1, 3, 4, 5, 16, 17, 33}) {
+    std::vector<uint8_t> src(pixels * 4);
+    for (size_t i = 0; i < src.size(); i++) {
+      src[i] = static_cast<uint8_t>(i * 7 + 1);
+    }
+    std::vector<uint8_t> dst(src.size());
+    argbToRgba(src.data(), dst.data(), src.size());
+
+    for (size_t i = 0; i < src.size(); i += 4) {
+      REQUIRE(dst[i] == src[i + 1]);
+      REQUIRE(dst[i + 1] == src[i + 2]);
+      REQUIRE(dst[i + 2] == src[i + 3]);
+      REQUIRE(dst[i + 3] == src[i]);
+    }
+
+    // In place
+    std::vector<uint8_t> buf = src;
+    argbToRgba(buf.data(), buf.data(), buf.size());
+    REQUIRE(buf == dst);
+  }
+}
+
+TEST_CASE("Hash pixmap bytes", "[argb_pixmap]") {
+  std::vector<uint8_t> a(64 * 64 * 4, 0x42);
+  std::vector<uint8_t> b = a;
+  REQUIRE(hashBytes(a.data(), a.size()) == hashBytes(b.data(), b.size()));
+
+  b[b.size() / 2] ^= 1;
+  REQUIRE(hashBytes(a.data(), a.size()) != hashBytes(b.data(), b.size()));
+  REQUIRE(hashBytes(a.data(), a.size() - 4) != hashBytes(a.data(), a.size()));
+  REQUIRE(hashBytes(a.data(), a.size(), 1) != hashBytes(a.data(), a.size(), 2));
+}
+
+TEST_CASE("Select the pixmap frame closest to the icon size", "[argb_pixmap]") {
+  REQUIRE(selectPixmapFrame({}, 24) == -1);
+
+  std::vector<PixmapSize> sizes = {{16, 16}, {64, 64}, {32, 32}, {256, 256}};
+  REQUIRE(selectPixmapFrame(sizes, 24) == 2);
+  REQUIRE(selectPixmapFrame(sizes, 32) == 2);
+  REQUIRE(selectPixmapFrame(sizes, 16) == 0);
+  REQUIRE(selectPixmapFrame(sizes, 48) == 1);
+  // Nothing is large enough: take the largest
+  REQUIRE(selectPixmapFrame(sizes, 512) == 3);
+  REQUIRE(selectPixmapFrame({{22, 22}}, 48) == 0);
+}
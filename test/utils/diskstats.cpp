@@ -0,0 +1,71 @@
+#include "util/diskstats.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <string>
+#include <vector>
+
+using waybar::util::DiskStats;
+using waybar::util::scanDiskstats;
+
+namespace {
+
+const std::string DISKSTATS =
+    "   7       0 loop0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n"
+    " 259       0 nvme0n1 1000 10 80000 300 2000 20 160000 900 3 4500 1200 0 0 0 0 50 7\n"
+    " 259       1 nvme0n1p1 900 10 72000 280 1900 20 152000 850 0 4000 1130 0 0 0 0 0 0\n"
+    "   8       0 sda 5 0 40 1 6 0 48 2 0 7 3\n"
+    "   8      16 sdb 5 0 40\n"
+    " 253       0 dm-0 1 2 3 4 5 6 7 x 9 10 11 12 13 14 15 16 17";
+
+}  // namespace
+
+TEST_CASE("scanDiskstats parses accepted lines", "[diskstats]") {
+  std::vector<std::string> names;
+  std::vector<DiskStats> stats;
+  scanDiskstats(
+      DISKSTATS, [](std::string_view) { return true; },
+      [&](const DiskStats& disk) {
+        names.emplace_back(disk.name);
+        stats.push_back(disk);
+      });
+
+  // sdb is truncated and dm-0 has a non-numeric counter
+  REQUIRE(names == std::vector<std::string>{"loop0", "nvme0n1", "nvme0n1p1", "sda"});
+  REQUIRE(stats[1].reads == 1000);
+  REQUIRE(stats[1].read_sectors == 80000);
+  REQUIRE(stats[1].writes == 2000);
+  REQUIRE(stats[1].write_sectors == 160000);
+  REQUIRE(stats[1].io_ticks == 4500);
+  // Kernels before 4.18 have no discard counters
+  REQUIRE(stats[3].writes == 6);
+  REQUIRE(stats[3].io_ticks == 7);
+}
+
+TEST_CASE("scanDiskstats skips rejected lines before parsing them", "[diskstats]") {
+  std::vector<std::string> offered;
+  std::vector<std::string> parsed;
+  scanDiskstats(
+      DISKSTATS,
+      [&](std::string_view name) {
+        offered.emplace_back(name);
+        return name.substr(0, 4) == "nvme";
+      },
+      [&](const DiskStats& disk) { parsed.emplace_back(disk.name); });
+
+  REQUIRE(offered.size() == 6);
+  REQUIRE(parsed == std::vector<std::string>{"nvme0n1", "nvme0n1p1"});
+}
+
+TEST_CASE("scanDiskstats handles empty input", "[diskstats]") {
+  int lines = 0;
+  scanDiskstats(
+      "", [](std::string_view) { return true; }, [&](const DiskStats&) { lines++; });
+  scanDiskstats(
+      "\n\n", [](std::string_view) { return true; }, [&](const DiskStats&) { lines++; });
+  REQUIRE(lines == 0);
+}
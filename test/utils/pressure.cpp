@@ -0,0 +1,64 @@
+#include "util/pressure.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <string>
+
+using waybar::util::parsePressure;
+using waybar::util::unprivilegedTrigger;
+
+TEST_CASE("parsePressure reads some and full lines", "[pressure]") {
+  auto pressure = parsePressure(
+      "some avg10=1.50 avg60=0.75 avg300=0.10 total=123456\n"
+      "full avg10=0.25 avg60=0.05 avg300=0.00 total=4567\n");
+  REQUIRE(pressure.some.avg10 == 1.5);
+  REQUIRE(pressure.some.avg60 == 0.75);
+  REQUIRE(pressure.some.avg300 == 0.1);
+  REQUIRE(pressure.some.total == 123456);
+  REQUIRE(pressure.full.avg10 == 0.25);
+  REQUIRE(pressure.full.avg60 == 0.05);
+  REQUIRE(pressure.full.avg300 == 0);
+  REQUIRE(pressure.full.total == 4567);
+}
+
+TEST_CASE("parsePressure leaves a missing full line at zero", "[pressure]") {
+  // The cpu resource of kernels before 5.13
+  auto pressure = parsePressure("some avg10=2.00 avg60=1.00 avg300=0.50 total=99\n");
+  REQUIRE(pressure.some.avg10 == 2);
+  REQUIRE(pressure.some.total == 99);
+  REQUIRE(pressure.full.avg10 == 0);
+  REQUIRE(pressure.full.avg60 == 0);
+  REQUIRE(pressure.full.avg300 == 0);
+  REQUIRE(pressure.full.total == 0);
+}
+
+TEST_CASE("parsePressure skips malformed fields", "[pressure]") {
+  auto pressure = parsePressure(
+      "some avg10=abc avg60 avg300=0.5x total=12\n"
+      "other avg10=9.00\n"
+      "full avg10= avg60=3.00 total=-\n");
+  REQUIRE(pressure.some.avg10 == 0);
+  REQUIRE(pressure.some.avg60 == 0);
+  REQUIRE(pressure.some.avg300 == 0);
+  REQUIRE(pressure.some.total == 12);
+  REQUIRE(pressure.full.avg10 == 0);
+  REQUIRE(pressure.full.avg60 == 3);
+  REQUIRE(pressure.full.total == 0);
+
+  auto empty = parsePressure("");
+  REQUIRE(empty.some.avg10 == 0);
+  REQUIRE(empty.full.total == 0);
+}
+
+TEST_CASE("unprivilegedTrigger rounds the window up to two seconds", "[pressure]") {
+  REQUIRE(unprivilegedTrigger("some 150000 1000000") == "some 150000 2000000");
+  REQUIRE(unprivilegedTrigger("full 500000 3000000") == "full 500000 4000000");
+  // Already allowed, nothing to retry
+  REQUIRE(unprivilegedTrigger("some 150000 2000000") == std::nullopt);
+  REQUIRE(unprivilegedTrigger("some 150000") == std::nullopt);
+  REQUIRE(unprivilegedTrigger("garbage") == std::nullopt);
+}
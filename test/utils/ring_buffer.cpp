@@ -0,0 +1,58 @@
+#include "util/ring_buffer.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <vector>
+
+using waybar::util::RingBuffer;
+
+namespace {
+
+std::vector<int> contents(const RingBuffer<int>& buffer) {
+  std::vector<int> values;
+  for (size_t i = 0; i < buffer.size(); i++) {
+    values.push_back(buffer[i]);
+  }
+  return values;
+}
+
+}  // namespace
+
+TEST_CASE("RingBuffer keeps the latest values in order", "[ring_buffer]") {
+  RingBuffer<int> buffer(3);
+  REQUIRE(buffer.empty());
+  REQUIRE(buffer.capacity() == 3);
+
+  buffer.push(1);
+  buffer.push(2);
+  REQUIRE(contents(buffer) == std::vector<int>{1, 2});
+  REQUIRE_FALSE(buffer.full());
+  REQUIRE(buffer.back() == 2);
+
+  buffer.push(3);
+  buffer.push(4);
+  buffer.push(5);
+  REQUIRE(buffer.full());
+  REQUIRE(contents(buffer) == std::vector<int>{3, 4, 5});
+  REQUIRE(buffer.back() == 5);
+
+  SECTION("clear empties the buffer but keeps its capacity") {
+    buffer.clear();
+    REQUIRE(buffer.empty());
+    REQUIRE(buffer.capacity() == 3);
+    buffer.push(6);
+    REQUIRE(contents(buffer) == std::vector<int>{6});
+  }
+}
+
+TEST_CASE("RingBuffer holds at least one value", "[ring_buffer]") {
+  RingBuffer<int> buffer(0);
+  REQUIRE(buffer.capacity() == 1);
+  buffer.push(1);
+  buffer.push(2);
+  REQUIRE(contents(buffer) == std::vector<int>{2});
+}
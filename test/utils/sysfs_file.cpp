@@ -0,0 +1,47 @@
+#include "util/sysfs_file.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <filesystem>
+#include <fstream>
+
+using waybar::util::SysfsFile;
+
+namespace fs = std::filesystem;
+
+TEST_CASE("SysfsFile re-reads a file through the same descriptor", "[sysfs_file]") {
+  auto path = fs::temp_directory_path() / "waybar-test-sysfs-file";
+  std::ofstream(path) << "42\n";
+
+  SysfsFile file(path);
+  REQUIRE(file.isOpen());
+  REQUIRE(file.read() == "42\n");
+  REQUIRE(file.readLine() == "42");
+  REQUIRE(file.readNumber<int>() == 42);
+
+  SECTION("changed contents are picked up") {
+    std::ofstream(path, std::ios::trunc) << "-7 with trailing text\nsecond line\n";
+    REQUIRE(file.readLine() == "-7 with trailing text");
+    REQUIRE(file.readNumber<int>() == -7);
+    REQUIRE_FALSE(file.readNumber<unsigned>().has_value());
+  }
+
+  SECTION("non-numeric contents are no number") {
+    std::ofstream(path, std::ios::trunc) << "Discharging\n";
+    REQUIRE(file.readLine() == "Discharging");
+    REQUIRE_FALSE(file.readNumber<int>().has_value());
+  }
+
+  fs::remove(path);
+}
+
+TEST_CASE("SysfsFile of a missing file stays closed", "[sysfs_file]") {
+  SysfsFile file(fs::temp_directory_path() / "waybar-test-sysfs-file-missing");
+  REQUIRE_FALSE(file.isOpen());
+  REQUIRE_FALSE(file.read().has_value());
+  REQUIRE_FALSE(file.readNumber<int>().has_value());
+}
@@ -0,0 +1,76 @@
+#include "util/triple_buffer.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <atomic>
+#include <thread>
+
+using waybar::util::TripleBuffer;
+
+TEST_CASE("TripleBuffer hands over the latest value", "[triple_buffer]") {
+  TripleBuffer<int> buffer(-1);
+
+  REQUIRE_FALSE(buffer.consume());
+  REQUIRE(buffer.readBuffer() == -1);
+
+  buffer.writeBuffer() = 1;
+  REQUIRE_FALSE(buffer.publish());
+  REQUIRE(buffer.consume());
+  REQUIRE(buffer.readBuffer() == 1);
+  REQUIRE_FALSE(buffer.consume());
+  REQUIRE(buffer.readBuffer() == 1);
+
+  SECTION("unread values are dropped") {
+    buffer.writeBuffer() = 2;
+    REQUIRE_FALSE(buffer.publish());
+    buffer.writeBuffer() = 3;
+    REQUIRE(buffer.publish());
+    REQUIRE(buffer.consume());
+    REQUIRE(buffer.readBuffer() == 3);
+    REQUIRE(buffer.published() == 3);
+    REQUIRE(buffer.dropped() == 1);
+  }
+}
+
+TEST_CASE("TripleBuffer never tears values across threads", "[triple_buffer]") {
+  struct Frame {
+    uint64_t a{0};
+    uint64_t b{0};
+  };
+  TripleBuffer<Frame> buffer;
+  constexpr uint64_t FRAMES = 200000;
+  std::atomic<bool> done{false};
+
+  std::thread producer([&] {
+    for (uint64_t i = 1; i <= FRAMES; i++) {
+      buffer.writeBuffer() = {i, ~i};
+      buffer.publish();
+    }
+    done = true;
+  });
+
+  uint64_t last = 0;
+  bool consistent = true;
+  bool monotonic = true;
+  while (true) {
+    bool finished = done;
+    if (buffer.consume()) {
+      const auto& frame = buffer.readBuffer();
+      consistent = consistent && frame.b == ~frame.a;
+      monotonic = monotonic && frame.a > last;
+      last = frame.a;
+    } else if (finished) {
+      break;
+    }
+  }
+  producer.join();
+
+  REQUIRE(consistent);
+  REQUIRE(monotonic);
+  REQUIRE(last == FRAMES);
+  REQUIRE(buffer.published() == FRAMES);
+}